@@ -1,9 +1,13 @@
 #include "beeper.cpp"
+// Alert sounds, generated from melodies.rtttl
+#include "melodies.cpp"
 
 #define BEEPER_PIN 4
 
 #define PLAY_STARTUP true
 #define DUTY_CYCLE_ALERT 0.75 // 0 to disable
+#define DUTY_CYCLE_CONTINUOUS true // warning follows the duty cycle, false beeps once per second
+#define DUTY_CYCLE_WARNING_FULL 0.95 // duty cycle with the highest and fastest warning
 #define LOW_VOLTAGE 58.9 // 0 to disable
 #define FULL_VOLTAGE 79.8 // Voltage of battery when fully charged
 #define LOW_VOLTAGE_INTERVAL 5 * 1000 // every 30 seconds
@@ -16,19 +20,49 @@ class BalanceBeeper {
     long lastDutyCycleAlertMillis = 0;
     const long DUTY_CYCLE_ALERT_INTERVAL = 1000; // Alert every 1 second max
     
-    // Buzzer timing control to prevent fast loop interference
-    long lastBuzzerUpdateMillis = 0;
-    const long BUZZER_UPDATE_INTERVAL = 10; // Update buzzer every 10ms instead of every loop
-    
-    // Alert priority system
-    enum AlertPriority {
+    // Alert priority system, lower values preempt higher ones
+    enum AlertPriority : uint8_t {
       PRIORITY_NONE = 0,
       PRIORITY_DUTY_CYCLE = 1,    // Highest priority
       PRIORITY_LOW_VOLTAGE = 2,   // Lower priority
-      PRIORITY_STARTUP = 3        // Lowest priority
+      PRIORITY_STARTUP = 3,       // Lowest priority
+      PRIORITY_COUNT
     };
     
     AlertPriority currentPriority = PRIORITY_NONE;
+    const uint16_t *currentMelody = NULL;
+
+    // Alerts waiting for a higher priority one to finish, one slot per
+    // priority so a repeated alert replaces the one already waiting
+    uint8_t pendingMask = 0; // bit n set when priority n waits
+    const uint16_t *pendingMelody[PRIORITY_COUNT];
+
+    // Play an alert now if it outranks the playing one, otherwise queue it
+    void queueAlert(AlertPriority priority, const uint16_t *melody) {
+      if (isPlaying() && priority == currentPriority) {
+        return; // already sounding
+      }
+      if (isPlaying() && priority > currentPriority) {
+        pendingMask |= 1 << priority;
+        pendingMelody[priority] = melody;
+        return;
+      }
+      // A preempted alert is dropped, the repeating ones come back on their own
+      startAlert(priority, melody);
+    }
+
+    void startAlert(AlertPriority priority, const uint16_t *melody) {
+      // The duty cycle warning turns melodies away, the alert waits for it
+      if (!beeper.play(melody, true)) {
+        pendingMask |= 1 << priority;
+        pendingMelody[priority] = melody;
+        return;
+      }
+      pendingMask &= ~(1 << priority);
+      currentPriority = priority;
+      currentMelody = melody;
+    }
+
   public:
     BalanceBeeper() :
       beeper(BEEPER_PIN){
@@ -36,47 +70,85 @@ class BalanceBeeper {
     void setup(){ 
       beeper.setup();
       if(PLAY_STARTUP){
-        beeper.queueThreeShort();
-        currentPriority = PRIORITY_STARTUP;
+        queueAlert(PRIORITY_STARTUP, MELODY_THREE_SHORT);
       }
     }
     
+#ifdef __AVR__
+    // Timer interrupts of the beeper, see beeper.cpp
+    void onTick() {
+      beeper.onTick();
+    }
+
+    void onToggle() {
+      beeper.onToggle();
+    }
+#endif
+
     // Check if buzzer is currently playing
     bool isPlaying() {
-      return beeper.isBeeping;
+      return beeper.isBeeping();
     }
     
-    // Update priority when buzzer finishes
+    // Warning level for the continuous duty cycle warning, 0 below the alert
+    uint8_t dutyWarningLevel(double dutyCycle) {
+      double duty = fabsf(dutyCycle);
+      if (duty <= DUTY_CYCLE_ALERT) {
+        return 0;
+      }
+      if (duty >= DUTY_CYCLE_WARNING_FULL) {
+        return 255;
+      }
+      return 1 + (uint8_t)((duty - DUTY_CYCLE_ALERT) * 254 / (DUTY_CYCLE_WARNING_FULL - DUTY_CYCLE_ALERT));
+    }
+
+    // Start the most important waiting alert when the buzzer finishes
     void updatePriority() {
-      if (!isPlaying() && currentPriority != PRIORITY_NONE) {
-        currentPriority = PRIORITY_NONE;
+      if (isPlaying()) {
+        return;
+      }
+      currentPriority = PRIORITY_NONE;
+      for (uint8_t priority = PRIORITY_NONE + 1; pendingMask != 0; priority++) {
+        if (pendingMask & (1 << priority)) {
+          startAlert((AlertPriority)priority, pendingMelody[priority]);
+          return;
+        }
       }
     }
 
     void loop(double dutyCycle, double erpm, double voltage){
-      // Only update buzzer at controlled intervals to prevent fast loop interference
-      if (millis() - lastBuzzerUpdateMillis >= BUZZER_UPDATE_INTERVAL) {
-        beeper.loop();
-        lastBuzzerUpdateMillis = millis();
+      // Notes are stepped from a timer interrupt on AVR, loop() only does it elsewhere
+      beeper.loop();
+
+      // Duty Cycle Alert - HIGHEST PRIORITY, cuts off anything else
+      if(DUTY_CYCLE_CONTINUOUS && DUTY_CYCLE_ALERT > 0){
+        // Follows every new sample, the beeper changes pitch right away
+        uint8_t level = dutyWarningLevel(dutyCycle);
+        if(level > 0 && currentPriority > PRIORITY_DUTY_CYCLE && isPlaying()){
+          // The warning cuts the alert off, it is played again once the
+          // warning stops
+          pendingMask |= 1 << currentPriority;
+          pendingMelody[currentPriority] = currentMelody;
+        }
+        beeper.setWarning(level);
+        if(level > 0){
+          currentPriority = PRIORITY_DUTY_CYCLE;
+        }
       }
+      // Checked after the warning, so a waiting alert doesn't start just to
+      // be cut off by it
       updatePriority();
-
-      // Duty Cycle Alert - HIGHEST PRIORITY
-      if(fabsf(dutyCycle) > DUTY_CYCLE_ALERT && DUTY_CYCLE_ALERT > 0 && 
-         lastDutyCycleAlertMillis + DUTY_CYCLE_ALERT_INTERVAL < millis() &&
-         (currentPriority == PRIORITY_NONE || currentPriority >= PRIORITY_DUTY_CYCLE)){
-        beeper.queueShortSingle();
+      if(!DUTY_CYCLE_CONTINUOUS && fabsf(dutyCycle) > DUTY_CYCLE_ALERT && DUTY_CYCLE_ALERT > 0 && 
+         lastDutyCycleAlertMillis + DUTY_CYCLE_ALERT_INTERVAL < millis()){
+        queueAlert(PRIORITY_DUTY_CYCLE, MELODY_SHORT_SINGLE);
         lastDutyCycleAlertMillis = millis();
-        currentPriority = PRIORITY_DUTY_CYCLE;
       }
 
-      // Low voltage - LOWER PRIORITY (only if no higher priority alert is playing)
+      // Low voltage - LOWER PRIORITY, waits for a duty cycle alert to finish
       if(voltage < LOW_VOLTAGE && LOW_VOLTAGE > 0 && 
-         lastLowVoltageMillis + LOW_VOLTAGE_INTERVAL < millis() &&
-         (currentPriority == PRIORITY_NONE || currentPriority >= PRIORITY_LOW_VOLTAGE)){
-        beeper.queueSad();
+         lastLowVoltageMillis + LOW_VOLTAGE_INTERVAL < millis()){
+        queueAlert(PRIORITY_LOW_VOLTAGE, MELODY_SAD);
         lastLowVoltageMillis = millis();
-        currentPriority = PRIORITY_LOW_VOLTAGE;
       }
     }
 
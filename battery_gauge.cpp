@@ -0,0 +1,121 @@
+#ifndef BATTERY_GAUGE_CPP
+#define BATTERY_GAUGE_CPP
+
+#include <Arduino.h>
+
+// Point of an open circuit voltage curve, level 0 is empty and 255 is full
+struct BatteryCurvePoint {
+  uint16_t cellMillivolts;
+  uint8_t level;
+};
+
+// Resting cell voltage to state of charge, ascending voltage. Voltages outside
+// the curve are clamped to its ends.
+
+// Generic Li-ion NMC (Samsung 30Q, LG HG2)
+const BatteryCurvePoint BATTERY_CURVE_LIION_NMC[] PROGMEM = {
+  { 3000, 0 },   { 3300, 13 },  { 3450, 26 },  { 3550, 51 },
+  { 3600, 77 },  { 3650, 102 }, { 3720, 128 }, { 3800, 153 },
+  { 3880, 179 }, { 3970, 204 }, { 4070, 230 }, { 4200, 255 }
+};
+
+// High capacity Li-ion (Molicel P42A, Samsung 40T)
+const BatteryCurvePoint BATTERY_CURVE_LIION_P42A[] PROGMEM = {
+  { 2800, 0 },   { 3100, 8 },   { 3300, 23 },  { 3450, 51 },
+  { 3530, 77 },  { 3600, 102 }, { 3680, 128 }, { 3770, 153 },
+  { 3860, 179 }, { 3960, 204 }, { 4070, 230 }, { 4200, 255 }
+};
+
+// LiFePO4, flat in the middle so the gauge mostly moves near the ends
+const BatteryCurvePoint BATTERY_CURVE_LIFEPO4[] PROGMEM = {
+  { 2500, 0 },   { 3000, 23 },  { 3200, 36 },  { 3250, 51 },
+  { 3260, 77 },  { 3270, 102 }, { 3290, 153 }, { 3300, 179 },
+  { 3320, 230 }, { 3350, 252 }, { 3400, 255 }
+};
+
+// State of charge from the pack voltage.
+// The voltage is filtered with an exponential moving average that is only
+// updated when a new sample arrives. Samples taken under load sag below the
+// resting voltage, so they get a smaller weight than samples at low duty cycle.
+class BatteryGauge {
+  private:
+    static const uint8_t FRACTION_BITS = 4;   // filtered value is mV * 16
+    static const uint8_t RESTING_SHIFT = 2;   // EMA weight 1/4 at low duty cycle
+    static const uint8_t LOADED_SHIFT = 5;    // EMA weight 1/32 under load
+    static const uint16_t LOADED_DUTY = 200;  // duty cycle * 1000
+
+    const BatteryCurvePoint *curve; // in PROGMEM
+    uint8_t curvePoints;
+    uint8_t seriesCells;
+
+    int32_t filteredMillivolts = 0; // pack mV << FRACTION_BITS
+    bool hasSample = false;
+    uint8_t level = 0;
+
+    uint8_t levelFromCell(uint16_t millivolts) {
+      BatteryCurvePoint lower;
+      memcpy_P(&lower, &curve[0], sizeof(lower));
+      if (millivolts <= lower.cellMillivolts) {
+        return lower.level;
+      }
+      for (uint8_t i = 1; i < curvePoints; i++) {
+        BatteryCurvePoint upper;
+        memcpy_P(&upper, &curve[i], sizeof(upper));
+        if (millivolts < upper.cellMillivolts) {
+          uint16_t span = upper.cellMillivolts - lower.cellMillivolts;
+          uint16_t offset = millivolts - lower.cellMillivolts;
+          return lower.level + ((uint32_t)(upper.level - lower.level) * offset) / span;
+        }
+        lower = upper;
+      }
+      return lower.level;
+    }
+
+  public:
+    template<uint8_t N>
+    BatteryGauge(const BatteryCurvePoint (&batteryCurve)[N], uint8_t cells) :
+      curve(batteryCurve), curvePoints(N), seriesCells(cells) {
+    }
+
+    // Feed every new voltage sample. Returns true if the level changed.
+    bool addSample(double voltage, double dutyCycle) {
+      if (voltage <= 0.0) {
+        return false;
+      }
+
+      int32_t sample = (int32_t)(voltage * 1000.0) << FRACTION_BITS;
+      if (!hasSample) {
+        filteredMillivolts = sample;
+        hasSample = true;
+      } else {
+        int16_t duty = (int16_t)(dutyCycle * 1000.0);
+        bool loaded = duty > (int16_t)LOADED_DUTY || duty < -(int16_t)LOADED_DUTY;
+        filteredMillivolts += (sample - filteredMillivolts) >> (loaded ? LOADED_SHIFT : RESTING_SHIFT);
+      }
+
+      uint16_t cellMillivolts = (filteredMillivolts >> FRACTION_BITS) / seriesCells;
+      uint8_t next = levelFromCell(cellMillivolts);
+      if (next == level) {
+        return false;
+      }
+      level = next;
+      return true;
+    }
+
+    // False until the first voltage sample, the level is 0 until then
+    bool hasReading() {
+      return hasSample;
+    }
+
+    // State of charge, 0 is empty and 255 is full
+    uint8_t getLevel() {
+      return level;
+    }
+
+    // Filtered pack voltage
+    double getVoltage() {
+      return (filteredMillivolts >> FRACTION_BITS) / 1000.0;
+    }
+};
+
+#endif
@@ -1,158 +1,248 @@
+#ifndef BEEPER_CPP
+#define BEEPER_CPP
+
 #include <stdint.h>
 #include <Arduino.h>
 
+// A melody is a PROGMEM array of notes, each packed into one word: the MIDI
+// note number (0 is a rest) in the top 7 bits and the length in 10 ms steps
+// in the low 9 bits, up to 5.11 s. The melody ends with MELODY_END.
+// The sketch's melodies are compiled from RTTTL by tools/melody_compiler.py.
+#define MELODY_NOTE(note, ms) ((uint16_t)(((uint16_t)(note) << 9) | ((ms) / 10)))
+#define MELODY_REST(ms) MELODY_NOTE(0, ms)
+#define MELODY_END 0
+
+// Frequencies of the highest octave, MIDI notes 116 to 127, in Hz. Lower
+// notes are halved once per octave.
+const uint16_t BEEPER_TOP_OCTAVE[12] PROGMEM = {
+  6645, 7040, 7459, 7902, 8372, 8870, 9397, 9956, 10548, 11175, 11840, 12544
+};
+
+// Range of the continuous warning, from level 1 to 255
+#define WARNING_LOW_FREQUENCY 1000 // Hz
+#define WARNING_HIGH_FREQUENCY 3000
+#define WARNING_SLOW_PERIOD 500 // ms between beep starts
+#define WARNING_FAST_PERIOD 60
+
+inline uint16_t noteFrequency(uint8_t note) {
+  uint8_t below = 127 - note;
+  return pgm_read_word(&BEEPER_TOP_OCTAVE[11 - below % 12]) >> (below / 12);
+}
+
+// Plays one melody at a time. Only the current note is kept, the player reads
+// the next one from flash when it is due.
+//
+// On AVR the player runs from interrupts and loop() has nothing to do: a
+// compare interrupt on timer0 steps through the notes once per millisecond and
+// timer2 toggles the pin at the note frequency, so the timing doesn't depend on
+// how long the main loop takes. Timer2 is the timer tone() would use, which
+// can't be used next to it. The sketch routes both interrupts to the beeper:
+//     ISR(TIMER0_COMPA_vect) { beeper.onTick(); }
+//     ISR(TIMER2_COMPA_vect) { beeper.onToggle(); }
+// Elsewhere loop() steps through the notes and plays them with tone().
+//
+// Instead of a melody the beeper can sound a continuous warning, beeps whose
+// pitch and rate follow a level set by the sketch. It overrides melodies while
+// it is on and a new level is heard on the next beep, or right away mid beep.
 class Beeper {
   private:
-    struct Beep{
-       int startOffset = 0; 
-       int frequency = 0;
-       bool triggered = false;
-    };
     int pin;
-    long beepStartTime = 0;
-    int beepsLength = 0;
-    struct Beep beeps[20];
+#ifdef __AVR__
+    volatile uint8_t *pinToggle; // writing the mask to PINx toggles the pin
+    uint8_t pinMask;
+#endif
+    const uint16_t *cursor = NULL; // note being played
+    unsigned long noteStart = 0;
+    uint16_t noteLength = 0; // ms
+    volatile bool beeping = false;
+
+    volatile uint8_t warningLevel = 0; // 0 is off
+    uint16_t warningFrequency = 0;
+    uint16_t warningPeriod = 0; // ms, sounding for the first half
+    unsigned long warningStart = 0;
+    bool warningSounding = false;
+
+    void startTone(uint16_t frequency) {
+#ifdef __AVR__
+      // Timer2 in CTC mode, one compare match per half period. The smallest
+      // prescaler that fits the count in 8 bits keeps the pitch closest.
+      static const uint8_t PRESCALER_SHIFTS[7] = { 0, 3, 5, 6, 7, 8, 10 };
+      uint32_t halfPeriod = F_CPU / 2 / frequency;
+      uint8_t select = 0;
+      while (select < 6 && (halfPeriod >> PRESCALER_SHIFTS[select]) > 256) {
+        select++;
+      }
+      TCCR2B = 0;
+      TCNT2 = 0;
+      OCR2A = (halfPeriod >> PRESCALER_SHIFTS[select]) - 1;
+      TCCR2B = select + 1; // CS22:0, 1 is no prescaler
+      TIMSK2 |= (1 << OCIE2A);
+#else
+      tone(pin, frequency);
+#endif
+    }
+
+    void stopTone() {
+#ifdef __AVR__
+      TCCR2B = 0;
+      TIMSK2 &= ~(1 << OCIE2A);
+      digitalWrite(pin, LOW);
+#else
+      noTone(pin);
+#endif
+    }
+
+    // Start the note under the cursor, false at the end of the melody
+    bool startNote() {
+      uint16_t packed = pgm_read_word(cursor);
+      if (packed == MELODY_END) {
+        return false;
+      }
+      uint8_t note = packed >> 9;
+      noteLength = (packed & 0x1FF) * 10;
+      if (note > 0) {
+        startTone(noteFrequency(note));
+      } else {
+        stopTone();
+      }
+      return true;
+    }
+
+    // Beep on for the first half of every warning period
+    void updateWarning() {
+      unsigned long now = millis();
+      while (now - warningStart >= warningPeriod) {
+        warningStart += warningPeriod;
+      }
+      bool sounding = now - warningStart < warningPeriod / 2;
+      if (sounding != warningSounding) {
+        warningSounding = sounding;
+        if (sounding) {
+          startTone(warningFrequency);
+        } else {
+          stopTone();
+        }
+      }
+    }
+
+    // Move on to the notes that are due
+    void update() {
+      if (warningLevel) {
+        updateWarning();
+        return;
+      }
+      if (!beeping) {
+        return;
+      }
+      // Notes are timed from the start of the previous one, a late call
+      // shortens the next note instead of delaying the rest of the melody
+      unsigned long now = millis();
+      while (now - noteStart >= noteLength) {
+        noteStart += noteLength;
+        cursor++;
+        if (!startNote()) {
+          stopTone();
+          beeping = false;
+          return;
+        }
+      }
+    }
+
   public:
-    bool isBeeping = false;
     Beeper(int beeper_pin){
       pin = beeper_pin;
     }
-    
+
     void setup(){
+      pinMode(pin, OUTPUT);
+      digitalWrite(pin, LOW);
+#ifdef __AVR__
+      pinToggle = portInputRegister(digitalPinToPort(pin));
+      pinMask = digitalPinToBitMask(pin);
+      TCCR2B = 0;
+      TCCR2A = (1 << WGM21); // CTC
+      // Timer0 overflows every 1.024 ms for millis(), its compare match comes
+      // once per overflow halfway through
+      OCR0A = 0x80;
+      TIMSK0 |= (1 << OCIE0A);
+#endif
     }
 
     void loop(){
-      if(isBeeping){
-        long timeInBeeping = millis() - beepStartTime;
-        for(int i = 0; i < beepsLength; i++){
-          if(timeInBeeping > beeps[i].startOffset && beeps[i].triggered == false){
-            beeps[i].triggered = true;
-            if(beeps[i].frequency > 0){
-              tone(pin, beeps[i].frequency);
-            }else{
-              noTone(pin);
-            }
-            if(i == beepsLength -1){
-              isBeeping = false;
-            }
-          }
-        }
-      }
+#ifndef __AVR__
+      update();
+#endif
     }
 
-    void queueThreeShort(){
-      if(isBeeping){
-        return;
-      }
-      
-      beepStartTime = millis();
-      isBeeping = true;
-      beepsLength = 7;
-      // On 1
-      beeps[0].startOffset = 0;
-      beeps[0].frequency = 440;
-      beeps[0].triggered = false;
-      // Off
-      beeps[1].startOffset = 250;
-      beeps[1].frequency = 0;
-      beeps[1].triggered = false;
-      // On 2
-      beeps[2].startOffset = 350;
-      beeps[2].frequency = 880;
-      beeps[2].triggered = false;
-      // Off
-      beeps[3].startOffset = 600;
-      beeps[3].frequency = 0;
-      beeps[3].triggered = false;
-      // On 3
-      beeps[4].startOffset = 700;
-      beeps[4].frequency = 1760;
-      beeps[4].triggered = false;
-      // off
-      beeps[5].startOffset = 950;
-      beeps[5].frequency = 0;
-      beeps[5].triggered = false;
-      // off off
-      beeps[6].startOffset = 1050;
-      beeps[6].frequency = 0;
-      beeps[6].triggered = false;
+    bool isBeeping() {
+      return beeping || warningLevel;
     }
 
-    void queueShortSingle(){
-      if(isBeeping){
+    // Set the level of the continuous warning, 1 is the lowest and slowest,
+    // 255 the highest and fastest and 0 turns it off. A melody that is playing
+    // is cut off.
+    void setWarning(uint8_t level) {
+      if (level == warningLevel) {
         return;
       }
-      
-      beepStartTime = millis();
-      isBeeping = true;
-      beepsLength = 2;
-      // On 1
-      beeps[0].startOffset = 0;
-      beeps[0].frequency = 440;
-      beeps[0].triggered = false;
-      // Off
-      beeps[1].startOffset = 300;
-      beeps[1].frequency = 0;
-      beeps[1].triggered = false;
+#ifdef __AVR__
+      uint8_t sreg = SREG;
+      cli();
+#endif
+      if (level == 0) {
+        stopTone();
+        warningSounding = false;
+      } else {
+        warningFrequency = WARNING_LOW_FREQUENCY +
+          (uint32_t)(WARNING_HIGH_FREQUENCY - WARNING_LOW_FREQUENCY) * (level - 1) / 254;
+        warningPeriod = WARNING_SLOW_PERIOD -
+          (uint32_t)(WARNING_SLOW_PERIOD - WARNING_FAST_PERIOD) * (level - 1) / 254;
+        if (warningLevel == 0) {
+          beeping = false;
+          warningStart = millis();
+          warningSounding = true;
+          startTone(warningFrequency);
+        } else if (warningSounding) {
+          startTone(warningFrequency);
+        }
+      }
+      warningLevel = level;
+#ifdef __AVR__
+      SREG = sreg;
+#endif
     }
 
-    void queueLongSingle(){
-      if(isBeeping){
-        return;
+    // Start a melody. A playing melody is cut off with preempt, otherwise
+    // the new one is ignored, and so is any melody during a warning.
+    // Returns false when the melody was ignored.
+    bool play(const uint16_t *melody, bool preempt = false) {
+      if ((beeping && !preempt) || warningLevel) {
+        return false;
       }
-      
-      beepStartTime = millis();
-      isBeeping = true;
-      beepsLength = 3;
-      // On 1
-      beeps[0].startOffset = 0;
-      beeps[0].frequency = 440;
-      beeps[0].triggered = false;
-      // Off
-      beeps[1].startOffset = 750;
-      beeps[1].frequency = 0;
-      beeps[1].triggered = false;
-      // off off
-      beeps[2].startOffset = 1000;
-      beeps[2].frequency = 0;
-      beeps[2].triggered = false;
+#ifdef __AVR__
+      uint8_t sreg = SREG;
+      cli();
+#endif
+      cursor = melody;
+      noteStart = millis();
+      beeping = startNote();
+#ifdef __AVR__
+      SREG = sreg;
+#endif
+      return true;
     }
 
-    void queueSad(){
-      if(isBeeping){
-        return;
-      }
-      
-      beepStartTime = millis();
-      isBeeping = true;
-      beepsLength = 7;
-      // Sad
-      beeps[0].startOffset = 0;
-      beeps[0].frequency = 3000;
-      beeps[0].triggered = false;
-      // Sad
-      beeps[1].startOffset = 100;
-      beeps[1].frequency = 2500;
-      beeps[1].triggered = false;
-      // Sad
-      beeps[2].startOffset = 200;
-      beeps[2].frequency = 2000;
-      beeps[2].triggered = false;
-      // Sad
-      beeps[3].startOffset = 300;
-      beeps[3].frequency = 1500;
-      beeps[3].triggered = false;
-      // Sad
-      beeps[4].startOffset = 400;
-      beeps[4].frequency = 1000;
-      beeps[4].triggered = false;
-      // Sad
-      beeps[5].startOffset = 500;
-      beeps[5].frequency = 500;
-      beeps[5].triggered = false;
-      // off 
-      beeps[6].startOffset = 600;
-      beeps[6].frequency = 0;
-      beeps[6].triggered = false;
+#ifdef __AVR__
+    // Called from ISR(TIMER0_COMPA_vect)
+    void onTick() {
+      update();
     }
-};
\ No newline at end of file
+
+    // Called from ISR(TIMER2_COMPA_vect)
+    void onToggle() {
+      *pinToggle = pinMask;
+    }
+#endif
+};
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef BRAKE_DETECTOR_CPP
+#define BRAKE_DETECTOR_CPP
+
+#include <stdint.h>
+
+// Brake detection on timestamped ERPM samples.
+// Has no Arduino dependencies so it can be fed recorded samples on a PC.
+class BrakeDetector {
+  private:
+    static const uint8_t FILTER_SHIFT = 2;         // EMA weight 1/4 per sample
+    static const uint8_t FRACTION_BITS = 4;        // filtered value is ERPM/s * 16
+    static const uint16_t MAX_SAMPLE_GAP_MS = 250; // older history is discarded
+    static const int32_t MAX_DECELERATION = 1000000L; // keeps the fixed point math in range
+
+    int32_t onDeceleration;   // ERPM/s
+    int32_t offDeceleration;  // ERPM/s
+    int32_t idleErpm;
+
+    int32_t lastErpm = 0;
+    uint32_t lastMillis = 0;
+    bool hasSample = false;
+
+    int32_t filteredDeceleration = 0; // ERPM/s << FRACTION_BITS
+    bool braking = false;
+
+  public:
+    BrakeDetector(int32_t onDecelerationErpmPerSecond, int32_t offDecelerationErpmPerSecond, int32_t idleThresholdErpm) :
+      onDeceleration(onDecelerationErpmPerSecond),
+      offDeceleration(offDecelerationErpmPerSecond),
+      idleErpm(idleThresholdErpm) {
+    }
+
+    // Feed every new ERPM sample with the time it was received.
+    // Returns true if the braking state changed.
+    bool addSample(int32_t erpm, uint32_t timestampMillis) {
+      bool wasBraking = braking;
+      uint32_t dt = timestampMillis - lastMillis;
+
+      if (!hasSample || dt > MAX_SAMPLE_GAP_MS) {
+        // No usable time base, start over
+        filteredDeceleration = 0;
+        braking = false;
+      } else if (dt == 0) {
+        return false;
+      } else {
+        // Deceleration is positive when the speed drops in the riding direction
+        int32_t delta = (erpm >= 0) ? lastErpm - erpm : erpm - lastErpm;
+        int32_t deceleration = (delta * 1000L) / (int32_t)dt;
+        if (deceleration > MAX_DECELERATION) deceleration = MAX_DECELERATION;
+        if (deceleration < -MAX_DECELERATION) deceleration = -MAX_DECELERATION;
+        filteredDeceleration += ((deceleration << FRACTION_BITS) - filteredDeceleration) >> FILTER_SHIFT;
+
+        bool moving = erpm > idleErpm || erpm < -idleErpm;
+        int32_t filtered = filteredDeceleration >> FRACTION_BITS;
+        if (!moving) {
+          braking = false;
+        } else if (braking) {
+          braking = filtered > offDeceleration;
+        } else {
+          braking = filtered > onDeceleration;
+        }
+      }
+
+      lastErpm = erpm;
+      lastMillis = timestampMillis;
+      hasSample = true;
+      return braking != wasBraking;
+    }
+
+    bool isBraking() {
+      return braking;
+    }
+
+    // Filtered deceleration in ERPM/s
+    int32_t getDeceleration() {
+      return filteredDeceleration >> FRACTION_BITS;
+    }
+};
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef BRIGHTNESS_RAMP_CPP
+#define BRIGHTNESS_RAMP_CPP
+
+#include <Arduino.h>
+#include <FastLED.h>
+
+// Eases the global brightness towards a target over a fixed time.
+// update() is called once per frame and only reports a change when the
+// brightness value actually moved.
+class BrightnessRamp {
+  private:
+    unsigned long duration;
+    unsigned long rampStart = 0;
+    uint8_t from;
+    uint8_t target;
+    uint8_t current;
+
+  public:
+    BrightnessRamp(uint8_t initialBrightness, unsigned long rampDuration) :
+      duration(rampDuration), from(initialBrightness), target(initialBrightness), current(initialBrightness) {
+    }
+
+    uint8_t get() {
+      return current;
+    }
+
+    // Start ramping from the current brightness, a ramp in progress is redirected
+    void setTarget(uint8_t brightness) {
+      if (brightness == target) {
+        return;
+      }
+      from = current;
+      target = brightness;
+      rampStart = millis();
+    }
+
+    // Returns true if the brightness changed since the last call
+    bool update(unsigned long now) {
+      uint8_t next;
+      unsigned long elapsed = now - rampStart;
+      if (elapsed >= duration) {
+        next = target;
+      } else {
+        uint8_t progress = ease8InOutQuad((elapsed * 255) / duration);
+        next = (target > from)
+          ? from + scale8(target - from, progress)
+          : from - scale8(from - target, progress);
+      }
+
+      if (next == current) {
+        return false;
+      }
+      current = next;
+      return true;
+    }
+};
+
+#endif
@@ -0,0 +1,157 @@
+#ifndef COMPOSITOR_CPP
+#define COMPOSITOR_CPP
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include "effects.cpp"
+
+// Layers of a strip, higher layers are drawn on top
+enum LayerId : uint8_t {
+  LAYER_BASE = 0,
+  LAYER_ANIMATION,
+  LAYER_BRAKE,
+  LAYER_ALERT,
+  LAYER_COUNT
+};
+
+enum BlendMode : uint8_t {
+  BLEND_ALPHA = 0, // nblend with the layer alpha, 255 replaces everything below
+  BLEND_LIGHTEN    // per channel maximum, black pixels are transparent
+};
+
+// Applied to a composed frame before it is copied to the LEDs, e.g. gamma
+typedef void (*FramePass)(CRGB *frame, uint16_t count);
+
+struct Layer {
+  uint8_t effect;  // index into the effect table, 0 is off
+  uint8_t alpha;
+  uint8_t mode;
+  unsigned long startMillis;
+  EffectState state;
+};
+
+// Composes the layers of one strip into its LED buffer.
+// The strip is only recomposed when a layer changed, a layer is animated or
+// the telemetry used by a layer changed. Layers below the topmost opaque layer
+// are not rendered, and the LED buffer is written once per composed frame.
+class LayeredStrip {
+  private:
+    CRGB *leds;
+    uint8_t count;
+    const Effect *effects; // effect table in PROGMEM
+    FramePass preShow;
+    Layer layers[LAYER_COUNT];
+    bool dirty = true;
+
+    uint8_t effectFlags(uint8_t effect) {
+      return pgm_read_byte(&effects[effect].flags);
+    }
+
+    void renderLayer(Layer &layer, CRGB *out, unsigned long now, const Telemetry &telemetry) {
+      EffectRender render = (EffectRender)pgm_read_ptr(&effects[layer.effect].render);
+      render(out, count, now - layer.startMillis, telemetry, layer.state);
+    }
+
+  public:
+    LayeredStrip(CRGB *stripLeds, uint8_t ledCount, const Effect *effectTable, FramePass preShowPass = NULL) :
+      leds(stripLeds), count(ledCount), effects(effectTable), preShow(preShowPass) {
+      for (uint8_t i = 0; i < LAYER_COUNT; i++) {
+        layers[i] = { 0, 0, BLEND_ALPHA, 0, { 0, 0, 0 } };
+      }
+    }
+
+    CRGB *getLeds() {
+      return leds;
+    }
+
+    // Set the effect of a layer, a running effect keeps its timing
+    void setLayer(LayerId id, uint8_t effect, uint8_t alpha = 255, BlendMode mode = BLEND_ALPHA) {
+      Layer &layer = layers[id];
+      if (layer.effect != effect) {
+        layer.effect = effect;
+        layer.startMillis = millis();
+        layer.state = { 0, 0, 0 };
+        dirty = true;
+      }
+      if (layer.alpha != alpha || layer.mode != mode) {
+        layer.alpha = alpha;
+        layer.mode = mode;
+        dirty = true;
+      }
+    }
+
+    void clearLayer(LayerId id) {
+      setLayer(id, 0, 0);
+    }
+
+    // Call when new telemetry arrived
+    void telemetryChanged() {
+      for (uint8_t i = 0; i < LAYER_COUNT; i++) {
+        if (layers[i].alpha > 0 && (effectFlags(layers[i].effect) & EFFECT_USES_TELEMETRY)) {
+          dirty = true;
+        }
+      }
+    }
+
+    // Compose into frame, using layerFrame for the upper layers. Both need
+    // room for count pixels and can be shared between strips.
+    // Returns true if the LED buffer changed.
+    bool render(unsigned long now, const Telemetry &telemetry, CRGB *frame, CRGB *layerFrame) {
+      uint8_t bottom = 0;
+      bool animated = false;
+      for (uint8_t i = 0; i < LAYER_COUNT; i++) {
+        if (layers[i].alpha == 0) {
+          continue;
+        }
+        if (layers[i].alpha == 255 && layers[i].mode == BLEND_ALPHA) {
+          bottom = i;
+          animated = false;
+        }
+        if (effectFlags(layers[i].effect) & EFFECT_ANIMATED) {
+          animated = true;
+        }
+      }
+      if (!dirty && !animated) {
+        return false;
+      }
+      dirty = false;
+
+      bool first = true;
+      for (uint8_t i = bottom; i < LAYER_COUNT; i++) {
+        Layer &layer = layers[i];
+        if (layer.alpha == 0) {
+          continue;
+        }
+        if (first) {
+          renderLayer(layer, frame, now, telemetry);
+          if (layer.alpha < 255) {
+            nscale8_video(frame, count, layer.alpha);
+          }
+          first = false;
+          continue;
+        }
+        renderLayer(layer, layerFrame, now, telemetry);
+        if (layer.mode == BLEND_LIGHTEN) {
+          for (uint8_t p = 0; p < count; p++) {
+            frame[p] |= layerFrame[p];
+          }
+        } else {
+          nblend(frame, layerFrame, count, layer.alpha);
+        }
+      }
+      if (first) {
+        fill_solid(frame, count, CRGB::Black);
+      }
+      if (preShow) {
+        preShow(frame, count);
+      }
+
+      if (memcmp(leds, frame, count * sizeof(CRGB)) == 0) {
+        return false;
+      }
+      memcpy(leds, frame, count * sizeof(CRGB));
+      return true;
+    }
+};
+
+#endif
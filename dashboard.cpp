@@ -0,0 +1,238 @@
+#ifndef DASHBOARD_CPP
+#define DASHBOARD_CPP
+
+#include <stdint.h>
+#include <string.h>
+#include <Arduino.h>
+#include <SSD1306Ascii.h>
+
+#define DASHBOARD_MAX_FIELDS 9
+#define DASHBOARD_FIELD_CHARS 8
+
+// Estimated I2C bytes of moving the cursor, three commands of address,
+// control and command byte
+#define DASHBOARD_CURSOR_BYTES 9
+
+// Estimated bytes of one row of w pixel columns, the cursor move and data
+// transmissions of up to 17 bytes with address and control byte. Also
+// covers what the row takes in the SSD1306AsciiWire queue.
+#define DASHBOARD_ROW_BYTES(w) (DASHBOARD_CURSOR_BYTES + (w) + 2 * (((w) + 16) / 17))
+
+// A value on the display. The text that is on the display is kept next to the
+// text that should be, only the characters that differ are sent. A field can
+// be drawn over several passes: when a proportional character changed width,
+// the characters behind it no longer sit where shown says, they are redrawn
+// from redrawFrom on whatever they are.
+struct DashboardField {
+  uint8_t col; // pixel column of the first character
+  uint8_t row;
+  uint8_t width; // characters
+  const uint8_t *font;
+  char shown[DASHBOARD_FIELD_CHARS]; // on the display
+  char text[DASHBOARD_FIELD_CHARS];  // to be drawn
+  uint8_t redrawFrom; // first character whose pixels are unknown, width if none
+  uint8_t end; // pixel column after the last one drawn
+  bool clean;
+};
+
+// Text fields on an SSD1306. A full redraw of the screen takes far too long for
+// the main loop, so update() only rewrites the characters that changed and
+// stops at the first character that doesn't fit in the I2C bytes it estimates
+// for this pass. The rest of that field is drawn first on the next pass. With
+// a proportional font the characters after one that changed width move and
+// are drawn again too.
+// Every field can have its own font, e.g. large digits cut down to the few
+// characters the field needs with tools/font_subset.py.
+class Dashboard {
+  private:
+    SSD1306Ascii &oled;
+    uint16_t byteBudget;
+    DashboardField fields[DASHBOARD_MAX_FIELDS];
+    uint8_t fieldCount = 0;
+    uint8_t nextField = 0;
+
+    // Pixels a character takes, none for one the font doesn't have
+    uint8_t spacing(char c) {
+      return oled.charWidth(c) ? oled.charSpacing(c) : 0;
+    }
+
+    // Draws what changed in a field until the next character would take
+    // bytes over budget, the estimated I2C bytes are added to bytes.
+    // over lets one character past the budget. Returns true when the field
+    // shows its text.
+    bool drawField(DashboardField &field, uint16_t budget, uint16_t &bytes, bool over) {
+      uint8_t rows = oled.fontRows();
+      uint8_t oldX = field.col;
+      uint8_t newX = field.col;
+      uint8_t cursorX = 0xFF; // where the cursor is after the last character drawn
+      for (uint8_t i = 0; i < field.width; i++) {
+        uint8_t oldSpacing = spacing(field.shown[i]);
+        uint8_t newSpacing = spacing(field.text[i]);
+        bool stale = i >= field.redrawFrom || field.text[i] != field.shown[i] || newX != oldX;
+        if (newSpacing && stale) {
+          // write() moves the cursor for every row of the font
+          uint16_t cost = rows * DASHBOARD_ROW_BYTES(newSpacing);
+          if (cursorX != newX) {
+            cost += DASHBOARD_CURSOR_BYTES;
+          }
+          if (bytes + cost > budget && !over) {
+            // What follows is still where shown says unless this one moved
+            // or the ones before it were redrawn anyway
+            if (newX != oldX || i >= field.redrawFrom) {
+              field.redrawFrom = i;
+            }
+            return false;
+          }
+          over = false;
+          if (cursorX != newX) {
+            oled.setCursor(newX, field.row);
+          }
+          oled.write((uint8_t)field.text[i]);
+          bytes += cost;
+          cursorX = newX + newSpacing;
+          if (cursorX > field.end) {
+            field.end = cursorX;
+          }
+        }
+        field.shown[i] = field.text[i];
+        oldX += oldSpacing;
+        newX += newSpacing;
+      }
+      field.redrawFrom = field.width;
+      // The new text is shorter, clear what is left of the old one
+      if (field.end > newX) {
+        uint16_t cost = rows * DASHBOARD_ROW_BYTES(field.end - newX);
+        if (bytes + cost > budget && !over) {
+          return false;
+        }
+        oled.clear(newX, field.end - 1, field.row, field.row + rows - 1);
+        bytes += cost;
+      }
+      field.end = newX;
+      return true;
+    }
+
+  public:
+    // Time of the last update() that drew anything and the longest one, for
+    // checking the byte budget against the real bus
+    uint16_t lastBytes = 0;
+    unsigned long lastMicros = 0;
+    unsigned long maxMicros = 0;
+
+    // byteBudget is the estimate of I2C bytes one update() may send, at
+    // 400 kHz a byte takes about 25 us. It should fit the largest character,
+    // one that doesn't is still drawn alone when the whole budget is free.
+    Dashboard(SSD1306Ascii &display, uint16_t byteBudget) :
+      oled(display), byteBudget(byteBudget) {
+    }
+
+    // Draws the label and adds a field of width characters behind it, in
+    // font or else the font of the label. Call after the display is cleared
+    // and the font of the labels is set. Returns the index of the field, or
+    // -1 when there is no room for it.
+    int8_t addField(uint8_t col, uint8_t row, const __FlashStringHelper *label, uint8_t width,
+                    const uint8_t *font = NULL) {
+      if (fieldCount == DASHBOARD_MAX_FIELDS || width > DASHBOARD_FIELD_CHARS) {
+        return -1;
+      }
+      oled.setCursor(col, row);
+      oled.print(label);
+      DashboardField &field = fields[fieldCount];
+      field.col = oled.col();
+      field.row = row;
+      field.width = width;
+      field.font = font ? font : oled.font();
+      memset(field.shown, ' ', sizeof(field.shown));
+      memset(field.text, ' ', sizeof(field.text));
+      field.redrawFrom = width;
+      field.end = field.col;
+      field.clean = true;
+      return fieldCount++;
+    }
+
+    // Left aligned text, cut off at the width of the field
+    void setText(uint8_t index, const char *text) {
+      DashboardField &field = fields[index];
+      uint8_t i = 0;
+      for (; i < field.width && text[i]; i++) {
+        field.clean &= field.text[i] == text[i];
+        field.text[i] = text[i];
+      }
+      for (; i < field.width; i++) {
+        field.clean &= field.text[i] == ' ';
+        field.text[i] = ' ';
+      }
+    }
+
+    // Right aligned number with decimals digits behind the point, 483 with
+    // one decimal shows as 48.3. Doesn't fit, shows ####.
+    void setNumber(uint8_t index, int32_t value, uint8_t decimals = 0) {
+      uint8_t width = fields[index].width;
+      char text[DASHBOARD_FIELD_CHARS + 1];
+      uint32_t magnitude = value < 0 ? -(uint32_t)value : value;
+      uint8_t i = width;
+      uint8_t digits = 0;
+      text[width] = 0;
+      // Digits from the right, at least one in front of the point
+      while (i > 0 && (magnitude || digits <= decimals)) {
+        text[--i] = '0' + magnitude % 10;
+        magnitude /= 10;
+        digits++;
+        if (digits == decimals && i > 0) {
+          text[--i] = '.';
+        }
+      }
+      if (value < 0 && i > 0) {
+        text[--i] = '-';
+      } else if (value < 0) {
+        magnitude = 1;
+      }
+      if (magnitude || digits <= decimals) {
+        memset(text, '#', width);
+      } else {
+        memset(text, ' ', i);
+      }
+      setText(index, text);
+    }
+
+    // True when every field shows its text
+    bool isClean() {
+      for (uint8_t i = 0; i < fieldCount; i++) {
+        if (!fields[i].clean) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    // Call every loop pass, draws the changed characters within the budget.
+    // room limits it further, e.g. to the free space of the display's write
+    // queue so that nothing has to wait for the bus.
+    void update(uint16_t room = 0xFFFF) {
+      unsigned long start = micros();
+      const uint8_t *labelFont = oled.font();
+      uint16_t budget = room < byteBudget ? room : byteBudget;
+      uint16_t bytes = 0;
+      for (uint8_t n = 0; n < fieldCount; n++) {
+        DashboardField &field = fields[nextField];
+        if (!field.clean) {
+          oled.setFont(field.font);
+          field.clean = drawField(field, budget, bytes, bytes == 0 && budget == byteBudget);
+          if (!field.clean) {
+            break;
+          }
+        }
+        nextField = (nextField + 1) % fieldCount;
+      }
+      oled.setFont(labelFont);
+      if (bytes > 0) {
+        lastBytes = bytes;
+        lastMicros = micros() - start;
+        if (lastMicros > maxMicros) {
+          maxMicros = lastMicros;
+        }
+      }
+    }
+};
+
+#endif
@@ -0,0 +1,55 @@
+// Generated by tools/font_subset.py from lcdnums14x24.h, 357 of 630 bytes, regenerate instead of editing
+// Characters: -.0123456789
+
+#ifndef _DASHBOARD_DIGITS_H
+#define _DASHBOARD_DIGITS_H
+
+GLCDFONTDECL(DASHBOARD_DIGITS) = {
+  0x00, 0x02, // run length encoded
+  13, // width
+  24, // height
+  '-', // first char
+  12, // char count
+  // chars
+  '-', '.', '0', '1', '2', '3', '4', '5', '6', '7', '8', '9',
+  // char widths
+  13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+  // offsets
+  0x00, 0x00, 0x00, 0x0A, 0x00, 0x13, 0x00, 0x32, 0x00, 0x44, 0x00, 0x63, 0x00, 0x81, 0x00, 0x9C, 0x00, 0xBB, 0x00, 0xDA, 0x00, 0xF1, 0x01, 0x10,
+  // '-'
+  0x8D, 0x00, 0x00, 0x10, 0x86, 0x38, 0x00, 0x10, 0x8C, 0x00,
+  // '.'
+  0x9D, 0x00, 0x03, 0x40, 0xE0, 0xE0, 0x40, 0x82, 0x00,
+  // '0'
+  0x03, 0x00, 0xFC, 0xFA, 0xF6, 0x84, 0x0E, 0x06, 0xF6, 0xFA, 0xFC, 0x00, 0xEF, 0xC7, 0x83, 0x84,
+  0x00, 0x06, 0x83, 0xC7, 0xEF, 0x00, 0x7F, 0xBF, 0xDF, 0x84, 0xE0, 0x02, 0xDF, 0xBF, 0x7F,
+  // '1'
+  0x88, 0x00, 0x02, 0xF0, 0xF8, 0xFC, 0x88, 0x00, 0x02, 0x83, 0xC7, 0xEF, 0x88, 0x00, 0x02, 0x1F,
+  0x3F, 0x7F,
+  // '2'
+  0x03, 0x00, 0x00, 0x02, 0x06, 0x84, 0x0E, 0x06, 0xF6, 0xFA, 0xFC, 0x00, 0xE0, 0xD0, 0xB8, 0x84,
+  0x38, 0x06, 0x3B, 0x17, 0x0F, 0x00, 0x7F, 0xBF, 0xDF, 0x84, 0xE0, 0x02, 0xC0, 0x80, 0x00,
+  // '3'
+  0x03, 0x00, 0x00, 0x02, 0x06, 0x84, 0x0E, 0x05, 0xF6, 0xFA, 0xFC, 0x00, 0x00, 0x10, 0x85, 0x38,
+  0x06, 0xBB, 0xD7, 0xEF, 0x00, 0x00, 0x80, 0xC0, 0x84, 0xE0, 0x02, 0xDF, 0xBF, 0x7F,
+  // '4'
+  0x03, 0x00, 0xFC, 0xF8, 0xF0, 0x84, 0x00, 0x06, 0xF0, 0xF8, 0xFC, 0x00, 0x0F, 0x17, 0x3B, 0x84,
+  0x38, 0x02, 0xBB, 0xD7, 0xEF, 0x88, 0x00, 0x02, 0x1F, 0x3F, 0x7F,
+  // '5'
+  0x03, 0x00, 0xFC, 0xFA, 0xF6, 0x84, 0x0E, 0x06, 0x06, 0x02, 0x00, 0x00, 0x0F, 0x17, 0x3B, 0x84,
+  0x38, 0x06, 0xB8, 0xD0, 0xE0, 0x00, 0x00, 0x80, 0xC0, 0x84, 0xE0, 0x02, 0xDF, 0xBF, 0x7F,
+  // '6'
+  0x03, 0x00, 0xFC, 0xFA, 0xF6, 0x84, 0x0E, 0x06, 0x06, 0x02, 0x00, 0x00, 0xEF, 0xD7, 0xBB, 0x84,
+  0x38, 0x06, 0xB8, 0xD0, 0xE0, 0x00, 0x7F, 0xBF, 0xDF, 0x84, 0xE0, 0x02, 0xDF, 0xBF, 0x7F,
+  // '7'
+  0x03, 0x00, 0x00, 0x02, 0x06, 0x84, 0x0E, 0x02, 0xF6, 0xFA, 0xFC, 0x88, 0x00, 0x02, 0x83, 0xC7,
+  0xEF, 0x88, 0x00, 0x02, 0x1F, 0x3F, 0x7F,
+  // '8'
+  0x03, 0x00, 0xFC, 0xFA, 0xF6, 0x84, 0x0E, 0x06, 0xF6, 0xFA, 0xFC, 0x00, 0xEF, 0xD7, 0xBB, 0x84,
+  0x38, 0x06, 0xBB, 0xD7, 0xEF, 0x00, 0x7F, 0xBF, 0xDF, 0x84, 0xE0, 0x02, 0xDF, 0xBF, 0x7F,
+  // '9'
+  0x03, 0x00, 0xFC, 0xFA, 0xF6, 0x84, 0x0E, 0x06, 0xF6, 0xFA, 0xFC, 0x00, 0x0F, 0x17, 0x3B, 0x84,
+  0x38, 0x06, 0xBB, 0xD7, 0xEF, 0x00, 0x00, 0x80, 0xC0, 0x84, 0xE0, 0x02, 0xDF, 0xBF, 0x7F,
+};
+
+#endif
@@ -0,0 +1,149 @@
+#ifndef EFFECTS_CPP
+#define EFFECTS_CPP
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include "telemetry.cpp"
+
+// Pack a color into a template argument
+#define EFFECT_COLOR(r, g, b) ((uint32_t(r) << 16) | (uint32_t(g) << 8) | uint32_t(b))
+
+// Motion that is integrated over the elapsed time, e.g. a position whose
+// speed follows the ERPM. The layer running the effect owns it, and it is
+// zeroed when the layer starts an effect.
+struct EffectState {
+  uint32_t lastT;
+  int32_t position;
+  int8_t direction;
+};
+
+// Every effect draws a complete frame from the time since it was started, so
+// skipped frames never change the animation speed. Effects keep no state of
+// their own, anything integrated over time lives in the layer's EffectState.
+typedef void (*EffectRender)(CRGB *out, uint8_t n, uint32_t t, const Telemetry &telemetry, EffectState &state);
+
+#define EFFECT_ANIMATED 0x01       // frame changes with t
+#define EFFECT_USES_TELEMETRY 0x02 // frame changes with the telemetry
+
+// Entry of an effect table
+struct Effect {
+  EffectRender render;
+  uint8_t flags;
+};
+
+// Effects are templates on their colors and timing, only the instantiations
+// listed in the sketch's effect table end up in flash.
+
+inline void effectOff(CRGB *out, uint8_t n, uint32_t, const Telemetry &, EffectState &) {
+  fill_solid(out, n, CRGB::Black);
+}
+
+template<uint32_t COLOR>
+void effectSolid(CRGB *out, uint8_t n, uint32_t, const Telemetry &, EffectState &) {
+  fill_solid(out, n, CRGB(COLOR));
+}
+
+// Every other LED lit, the idle tail light
+template<uint32_t COLOR>
+void effectAlternate(CRGB *out, uint8_t n, uint32_t, const Telemetry &, EffectState &) {
+  for (uint8_t i = 0; i < n; i++) {
+    out[i] = (i % 2 == 0) ? CRGB(COLOR) : CRGB(CRGB::Black);
+  }
+}
+
+// Bar that fills up over DURATION ms
+template<uint32_t COLOR, uint16_t DURATION>
+void effectLoadingBar(CRGB *out, uint8_t n, uint32_t t, const Telemetry &, EffectState &) {
+  uint8_t lit = (t >= DURATION) ? n : (uint8_t)((t * n) / DURATION);
+  for (uint8_t i = 0; i < n; i++) {
+    out[i] = (i < lit) ? CRGB(COLOR) : CRGB(CRGB::Black);
+  }
+}
+
+// One LED per 1/n of the state of charge, the rest in the alternate color.
+// The level is filtered and looked up once per sample by the BatteryGauge.
+template<uint32_t COLOR, uint32_t ALTERNATE_COLOR>
+void effectBatteryGauge(CRGB *out, uint8_t n, uint32_t, const Telemetry &telemetry, EffectState &) {
+  // Rounded up, any charge above empty lights the first LED
+  uint8_t lit = ((uint16_t)telemetry.batteryLevel * n + 254) / 255;
+  for (uint8_t i = 0; i < n; i++) {
+    out[i] = (i < lit) ? CRGB(COLOR) : CRGB(ALTERNATE_COLOR);
+  }
+}
+
+// Lights the half of the strip on the side of the pressed footpad
+template<uint32_t COLOR>
+void effectFootpadHint(CRGB *out, uint8_t n, uint32_t, const Telemetry &telemetry, EffectState &) {
+  for (uint8_t i = 0; i < n; i++) {
+    bool lit = (telemetry.footpad1 && i < n / 2) || (!telemetry.footpad1 && telemetry.footpad2 && i > n / 2);
+    out[i] = lit ? CRGB(COLOR) : CRGB(CRGB::Black);
+  }
+}
+
+// Length of [a0, a1) inside [b0, b1), all in Q8.8 pixels
+inline int32_t spanOverlap(int32_t a0, int32_t a1, int32_t b0, int32_t b1) {
+  int32_t overlap = min(a1, b1) - max(a0, b0);
+  return overlap > 0 ? overlap : 0;
+}
+
+// Bouncing bar with soft edges and a fading trail, speed follows the ERPM.
+// The position is Q8.8 fixed point and advanced by speed * elapsed time on
+// every frame, the bar edges are anti-aliased over the neighbouring pixels.
+// Position and direction are kept in the layer's state, so every strip has
+// its own scanner.
+template<uint32_t COLOR, uint8_t WIDTH>
+void effectKnightRider(CRGB *out, uint8_t n, uint32_t t, const Telemetry &telemetry, EffectState &state) {
+  const int32_t GLOW = 2 << 8;   // soft edge glow on both sides
+  const int32_t TRAIL = 4 << 8;  // fading trail behind the bar
+  const uint8_t GLOW_LEVEL = 77; // 30%
+  const uint8_t TRAIL_LEVEL = 150;
+
+  if (n <= WIDTH) {
+    fill_solid(out, n, CRGB(COLOR));
+    return;
+  }
+
+  int32_t &position = state.position; // Q8.8, left edge of the bar
+  int8_t &direction = state.direction;
+  if (direction == 0) {
+    direction = 1;
+  }
+  uint32_t dt = t - state.lastT;
+  state.lastT = t;
+
+  // Same speed curve as the stepping version: 80 ms per pixel at 200 ERPM, 5 ms at 20000
+  long erpm = abs(telemetry.erpm);
+  uint32_t msPerPixel = constrain(map(erpm, 200, 20000, 80, 5), 5L, 250L);
+  uint32_t speed = 256000UL / msPerPixel; // Q8.8 pixels per second
+
+  int32_t range = (int32_t)(n - WIDTH) << 8;
+  position += direction * (int32_t)((speed * min(dt, 250UL)) / 1000);
+  while (position > range || position < 0) {
+    if (position > range) {
+      position = 2 * range - position;
+      direction = -1;
+    } else {
+      position = -position;
+      direction = 1;
+    }
+  }
+
+  int32_t barEnd = position + ((int32_t)WIDTH << 8);
+  for (uint8_t i = 0; i < n; i++) {
+    int32_t pixel = (int32_t)i << 8;
+    uint16_t core = spanOverlap(pixel, pixel + 256, position, barEnd);
+    uint16_t glow = spanOverlap(pixel, pixel + 256, position - GLOW, barEnd + GLOW);
+    uint8_t level = (core >= 255) ? 255 : core;
+    level = max(level, scale8(glow >= 255 ? 255 : glow, GLOW_LEVEL));
+
+    // Distance behind the bar, measured from the pixel centre
+    int32_t behind = (direction > 0) ? position - (pixel + 128) : (pixel + 128) - barEnd;
+    if (behind > 0 && behind < TRAIL) {
+      level = max(level, (uint8_t)(((TRAIL - behind) * TRAIL_LEVEL) / TRAIL));
+    }
+
+    out[i] = CRGB(COLOR).nscale8_video(level);
+  }
+}
+
+#endif
@@ -4,12 +4,14 @@
 
 #define ESC_CAN_ID 107
 #define NODE_CAN_ID 36 // Your device's CAN ID
+#define RX_OVERFLOW_FLAGS 0xC0 // RX0OVR and RX1OVR in the MCP2515 EFLG register
 
 // Relevant CAN command IDs
 typedef enum {
   CAN_PACKET_PROCESS_SHORT_BUFFER = 8,
   CAN_PACKET_FILL_RX_BUFFER = 5,
   CAN_PACKET_PROCESS_RX_BUFFER = 7,
+  CAN_PACKET_STATUS = 9,    // ERPM, current and duty broadcast
   CAN_PACKET_STATUS_6 = 58  // ADC values broadcast
 } CAN_PACKET_ID;
 
@@ -26,6 +28,19 @@ class ESC {
     double voltage = 0.0;
     double dutyCycle = 0.0;
 
+    // Time the last erpm value was received, erpmUpdated is set on every new sample
+    unsigned long erpmMillis = 0;
+    bool erpmUpdated = false;
+
+    // Set on every new voltage sample, cleared by the consumer
+    bool voltageUpdated = false;
+
+    // Id of the last frame read, for stall diagnostics
+    uint32_t lastCanId = 0;
+
+    // Times the MCP2515 receive buffers overflowed, each one is at least one lost frame
+    uint16_t droppedFrames = 0;
+
         // ADC vars (normalized 0.0-1.0 from STATUS_6)
     double adc1 = 0.0;
     double adc2 = 0.0;
@@ -53,36 +68,28 @@ class ESC {
       return newData;
     }
 
-    // Optional: passive listening for any messages (not required for realtime)
-    void listenForMessages() {
+    // Passive listening for broadcast messages, returns true if new data was parsed
+    bool listenForMessages() {
+      bool newData = false;
 
       // Read ALL pending messages to avoid buffer overflow
       for (int i = 0; i < 10; i++) {  // Read up to 10 messages per call
         
-        if (mcp2515.readMessage(&rxFrame) == MCP2515::ERROR_OK) {
+        if (mcp2515.readMessage(&rxFrame) != MCP2515::ERROR_OK) {
           break;  // No more messages
         }
       
-        // Non-blocking read — only parses known message types
-        uint32_t id = rxFrame.can_id;
-        if (id == (0x80000000 + ((uint16_t)CAN_PACKET_FILL_RX_BUFFER << 8) + NODE_CAN_ID)) {
-          if (rxFrame.data[0] + rxFrame.can_dlc - 1 < sizeof(rxData)) {
-            memcpy(&rxData[rxFrame.data[0]], &rxFrame.data[1], rxFrame.can_dlc - 1);
-            rxLen += rxFrame.can_dlc - 1;
-          }
-        } 
-        else if (id == (0x80000000 + ((uint16_t)CAN_PACKET_PROCESS_RX_BUFFER << 8) + NODE_CAN_ID)) {
-          // Check if this is a realtime data response
-          if (rxLen >= 17 && rxData[0] == 0x32) {
-            parseRealtimeData();
-          }
-          rxLen = 0;    
-        }
-          // Handle STATUS_6 messages with ADC data
-        else if (id == (0x80000000 + ((uint16_t)CAN_PACKET_STATUS_6 << 8) + ESC_CAN_ID)) {
-          parseStatus6();
+        if (parseFrame()) {
+          newData = true;
         }
       }
+
+      if (mcp2515.getErrorFlags() & RX_OVERFLOW_FLAGS) {
+        droppedFrames++;
+        mcp2515.clearRXnOVRFlags();
+      }
+
+      return newData;
     }
 
   private:
@@ -100,38 +107,75 @@ class ESC {
       mcp2515.sendMessage(&msg);
     }
 
+    // Waits a short window for the reply. Broadcasts that arrive meanwhile go
+    // through the same parser, STATUS frames carry the timestamped ERPM samples.
     bool readRealtimeResponse() {
       bool dataReady = false;
 
-      // Small loop to catch frames for this transaction
       unsigned long startTime = millis();
       while (millis() - startTime < 5) { // very short window
-        if (mcp2515.readMessage(&rxFrame) == MCP2515::ERROR_OK) {
-          uint32_t id = rxFrame.can_id;
-
-          if (id == (0x80000000 + ((uint16_t)CAN_PACKET_FILL_RX_BUFFER << 8) + NODE_CAN_ID)) {
-            if (rxFrame.data[0] + rxFrame.can_dlc - 1 < sizeof(rxData)) {
-              memcpy(&rxData[rxFrame.data[0]], &rxFrame.data[1], rxFrame.can_dlc - 1);
-              rxLen += rxFrame.can_dlc - 1;
-            }
-          } else if (id == (0x80000000 + ((uint16_t)CAN_PACKET_PROCESS_RX_BUFFER << 8) + NODE_CAN_ID)) {
-            if (rxLen >= 17 && rxData[0] == 0x32) {
-              parseRealtimeData();
-              dataReady = true;
-            }
-            rxLen = 0;
-          }
+        if (mcp2515.readMessage(&rxFrame) == MCP2515::ERROR_OK && parseFrame()) {
+          dataReady = true;
         }
       }
 
       return dataReady;
     }
 
+    // Parses rxFrame if it is a known message type, returns true if it carried new data
+    bool parseFrame() {
+      uint32_t id = rxFrame.can_id;
+      lastCanId = id;
+      if (id == (0x80000000 + ((uint16_t)CAN_PACKET_FILL_RX_BUFFER << 8) + NODE_CAN_ID)) {
+        if (rxFrame.data[0] + rxFrame.can_dlc - 1 < sizeof(rxData)) {
+          memcpy(&rxData[rxFrame.data[0]], &rxFrame.data[1], rxFrame.can_dlc - 1);
+          rxLen += rxFrame.can_dlc - 1;
+        }
+      }
+      else if (id == (0x80000000 + ((uint16_t)CAN_PACKET_PROCESS_RX_BUFFER << 8) + NODE_CAN_ID)) {
+        // Check if this is a realtime data response
+        bool realtime = rxLen >= 17 && rxData[0] == 0x32;
+        if (realtime) {
+          parseRealtimeData();
+        }
+        rxLen = 0;
+        return realtime;
+      }
+      // Handle STATUS messages with ERPM and duty cycle
+      else if (id == (0x80000000 + ((uint16_t)CAN_PACKET_STATUS << 8) + ESC_CAN_ID)) {
+        parseStatus();
+        return true;
+      }
+      // Handle STATUS_6 messages with ADC data
+      else if (id == (0x80000000 + ((uint16_t)CAN_PACKET_STATUS_6 << 8) + ESC_CAN_ID)) {
+        parseStatus6();
+        return true;
+      }
+      return false;
+    }
+
     void parseRealtimeData() {
       dutyCycle = ((int16_t(rxData[9]) << 8) | int16_t(rxData[10])) / 1000.0;
       erpm      = ((int32_t(rxData[11]) << 24) | (int32_t(rxData[12]) << 16) |
                    (int32_t(rxData[13]) << 8)  | (int32_t(rxData[14])));
       voltage   = ((int16_t(rxData[15]) << 8) | int16_t(rxData[16])) / 10.0;
+      voltageUpdated = true;
+      erpmMillis = millis();
+      erpmUpdated = true;
+    }
+
+    // Parse STATUS (periodic ERPM broadcast, 50-100 Hz when enabled in VESC Tool)
+    void parseStatus() {
+      if (rxFrame.can_dlc < 8) {
+        return;
+      }
+
+      // STATUS format: [erpm int32][current int16 * 10][duty int16 * 1000]
+      erpm      = ((int32_t(rxFrame.data[0]) << 24) | (int32_t(rxFrame.data[1]) << 16) |
+                   (int32_t(rxFrame.data[2]) << 8)  | (int32_t(rxFrame.data[3])));
+      dutyCycle = int16_t((uint16_t(rxFrame.data[6]) << 8) | rxFrame.data[7]) / 1000.0;
+      erpmMillis = millis();
+      erpmUpdated = true;
     }
 
     // Parse STATUS_6 (periodic ADC broadcast)
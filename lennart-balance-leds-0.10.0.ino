@@ -5,6 +5,32 @@
 
 #include "balance_beeper.cpp"
 #include "esc.cpp"   // includes your updated ESC class
+#include "ride_state.cpp"
+#include "brake_detector.cpp"
+#include "loop_watchdog.cpp"
+#include "compositor.cpp"
+#include "brightness_ramp.cpp"
+#include "battery_gauge.cpp"
+
+// Optional SSD1306 display with voltage, ERPM, duty and footpads
+#define OLED_DASHBOARD false
+#define OLED_I2C_ADDRESS 0x3C
+#define DASHBOARD_UPDATE_INTERVAL 100 // ms between new values
+#define DASHBOARD_BYTE_BUDGET 120 // estimated I2C bytes of new characters at a time, fits the largest one
+#define DASHBOARD_SLICE_MICROS 1000 // I2C time per loop pass, the rest waits in the queue
+#define WIRE_QUEUE_SIZE 128 // bytes of display writes waiting for the bus
+#if DASHBOARD_BYTE_BUDGET > WIRE_QUEUE_SIZE
+#error "DASHBOARD_BYTE_BUDGET has to fit in WIRE_QUEUE_SIZE"
+#endif
+#define DASHBOARD_LOW_BATTERY 51 // level of 255 below which a warning scrolls along row 6
+#define DASHBOARD_TICKER_INTERVAL 30 // ms per pixel the warning moves, the display needs 2 frames (~20ms) per shift
+
+#if OLED_DASHBOARD
+#include <Wire.h>
+#include <SSD1306AsciiWire.h>
+#include "dashboard.cpp"
+#include "dashboard_font.h" // large digits for the voltage
+#endif
 
 // Front LEDs (U1)
 #define FLASHING_LED_RED 228
@@ -38,28 +64,72 @@
 
 #define BATTERY_INDICATOR_DURATION 5000 // 5 seconds
 
+// Battery pack, the gauge follows the resting voltage curve of the cells
+#define BATTERY_CURVE BATTERY_CURVE_LIION_P42A // or BATTERY_CURVE_LIION_NMC, BATTERY_CURVE_LIFEPO4
+#define BATTERY_SERIES_CELLS 19
+
 #define THRESHOLD 5000
 #define FAST_DELAY 20
 #define SLOW_DELAY 50
 #define STARTUP_BRIGHTNESS 30 
 #define NORMAL_BRIGHTNESS 255 
+#define BRIGHTNESS_RAMP_TIME 400 // ms to fade between startup and riding brightness
+#define LED_GAMMA_X10 22 // gamma 2.2, 10 turns gamma correction off
 
 #define NUM_LEDS 17 
 #define FORWARD_PIN 5
 #define REVERSE_PIN 6
 #define FORWARD 0
 #define REVERSE 1
+// The low phase after every byte is about 7us, above FASTLED_MAX_LOW_GAP_US (5us), check the strips before enabling
+#define PARALLEL_LED_OUTPUT false // send both strips at once, REVERSE_PIN has to be the next bit of FORWARD_PIN's port
 
-#define BRAKE_IDLE_THRESHOLD 200
-#define BRAKE_THRESHOLD 15
-#define BRAKE_ON_DEBOUNCE_COUNT 3 
-#define BRAKE_OFF_DEBOUNCE_COUNT 3
+#define LOOP_DEADLINE 50 // ms, longer loop passes are counted as overruns
 
-CRGB forward_leds[NUM_LEDS];
-CRGB reverse_leds[NUM_LEDS];
+#define BRAKE_IDLE_THRESHOLD 200
+#define BRAKE_ON_DECELERATION 300  // ERPM per second, filtered
+#define BRAKE_OFF_DECELERATION 150 // lower than on, so the light doesn't flicker
+
+// Both strips in one array, forward first, so they can be sent as lanes of one controller
+CRGB leds[2 * NUM_LEDS];
+CRGB *const forward_leds = leds;
+CRGB *const reverse_leds = leds + NUM_LEDS;
+
+#if PARALLEL_LED_OUTPUT && defined(FASTLED_AVR)
+// Clocks both strips out in the time of one
+AVRBlockClocklessController<2, FORWARD_PIN, C_NS(250), C_NS(625), C_NS(375), GRB> ledOutput;
+CLEDController &forwardController = ledOutput;
+CLEDController &reverseController = ledOutput;
+#else
+// Outputs keep the encoded GRB bytes, a strip that didn't change isn't sent again
+CEncodedLEDController<WS2812B<FORWARD_PIN, RGB>, GRB, NUM_LEDS> forwardOutput;
+CEncodedLEDController<WS2812B<REVERSE_PIN, RGB>, GRB, NUM_LEDS> reverseOutput;
+CLEDController &forwardController = forwardOutput;
+CLEDController &reverseController = reverseOutput;
+#endif
 
 ESC esc;
 BalanceBeeper balanceBeeper;
+LoopWatchdog loopWatchdog(LOOP_DEADLINE);
+
+void onRideStateEnter(RideState state);
+void onRideStateExit(RideState state);
+RideStateMachine rideState(onRideStateEnter, onRideStateExit);
+Telemetry telemetry;
+BrakeDetector brakeDetector(BRAKE_ON_DECELERATION, BRAKE_OFF_DECELERATION, BRAKE_IDLE_THRESHOLD);
+BatteryGauge batteryGauge(BATTERY_CURVE, BATTERY_SERIES_CELLS);
+
+#if OLED_DASHBOARD
+SSD1306AsciiWire oled;
+Dashboard dashboard(oled, DASHBOARD_BYTE_BUDGET);
+int8_t voltageField, erpmField, dutyField, footpadField, i2cTimeField;
+int8_t overrunField, longestLoopField, overrunStageField, droppedFramesField;
+unsigned long lastDashboardMillis = 0;
+unsigned long longestI2cSlice = 0;
+// The controller shifts the banner, a tick only sends the new column
+TickerState lowBatteryTicker;
+unsigned long lastTickerMillis = 0;
+#endif
 
 // Global variables for ESC data
 double globalErpm = 0.0;
@@ -73,73 +143,98 @@ const unsigned long CAN_POLLING_INTERVAL = 100; // every 100ms
 unsigned long lastCanPollTime = 0;
 
 // LED & animation states
-unsigned long lastKnightRiderUpdate = 0;
-unsigned long lastBrakeCheckMillis = 0;
-const unsigned long brakeCheckInterval = 50;
 unsigned long lastLEDUpdateMillis = 0;
 const unsigned long LED_UPDATE_INTERVAL = 16; // ~60 FPS
 
-// Battery percent variables
-unsigned long voltageAcquiredMS = 0;
-bool voltageAcquired = false;
-bool returningToStartup = false;
-
-// Footpad sensor variables
-unsigned long lastFootpadTriggerMillis = 0;
-bool isInitialStartup = true;
-
-// Startup Animation variables
-unsigned long startupBeginMS = 0;
-bool startupAnimationComplete = false;
 const unsigned long STARTUP_ANIMATION_DURATION = 5000; // 5 seconds
 
-int currentLEDIndex = 0;
 int direction = FORWARD;
-int animationDirFlag = 1;
-int previousErpm = 0;
 
-bool startupState = true; 
-bool movingState = false; 
-bool isBraking = false;
-
-void knightRider(int red, int green, int blue, int ridingWidth);
-void checkBraking();
+// Effects used by this sketch, index into EFFECTS
+enum EffectId : uint8_t {
+  EFFECT_OFF = 0,
+  EFFECT_HEADLIGHT,
+  EFFECT_TAIL_LIGHT,
+  EFFECT_BRAKE_LIGHT,
+  EFFECT_STARTUP,
+  EFFECT_BATTERY_GAUGE,
+  EFFECT_FOOTPAD_HINT,
+  EFFECT_KNIGHT_RIDER
+};
+
+constexpr Effect EFFECTS[] PROGMEM = {
+  { effectOff, 0 },
+  { effectSolid<EFFECT_COLOR(FLASHING_LED_RED, FLASHING_LED_GREEN, FLASHING_LED_BLUE)>, 0 },
+  { effectAlternate<EFFECT_COLOR(CONSTANT_LED_RED, CONSTANT_LED_GREEN, CONSTANT_LED_BLUE)>, 0 },
+  { effectSolid<EFFECT_COLOR(CONSTANT_LED_RED, CONSTANT_LED_GREEN, CONSTANT_LED_BLUE)>, 0 },
+  { effectLoadingBar<EFFECT_COLOR(STARTUP_ANIMATION_LED_RED, STARTUP_ANIMATION_LED_GREEN, STARTUP_ANIMATION_LED_BLUE),
+                     STARTUP_ANIMATION_DURATION>, EFFECT_ANIMATED },
+  { effectBatteryGauge<EFFECT_COLOR(BATTERY_INDICATOR_LED_RED, BATTERY_INDICATOR_LED_GREEN, BATTERY_INDICATOR_LED_BLUE),
+                       EFFECT_COLOR(BATTERY_INDICATOR_ALTERNATE_LED_RED, BATTERY_INDICATOR_ALTERNATE_LED_GREEN, BATTERY_INDICATOR_ALTERNATE_LED_BLUE)>,
+    EFFECT_USES_TELEMETRY },
+  { effectFootpadHint<EFFECT_COLOR(FOOTPAD_INDICATOR_LED_RED, FOOTPAD_INDICATOR_LED_GREEN, FOOTPAD_INDICATOR_LED_BLUE)>, EFFECT_USES_TELEMETRY },
+  { effectKnightRider<EFFECT_COLOR(FLASHING_LED_RED, FLASHING_LED_GREEN, FLASHING_LED_BLUE), 5>, EFFECT_ANIMATED | EFFECT_USES_TELEMETRY },
+};
+
+LayeredStrip forwardStrip(forward_leds, NUM_LEDS, EFFECTS, napplyGamma_video<LED_GAMMA_X10>);
+LayeredStrip reverseStrip(reverse_leds, NUM_LEDS, EFFECTS, napplyGamma_video<LED_GAMMA_X10>);
+
+// Scratch frames for the compositor, shared by both strips
+CRGB composedFrame[NUM_LEDS];
+CRGB layerFrame[NUM_LEDS];
+bool brightnessChanged = true;
+
+BrightnessRamp brightnessRamp(STARTUP_BRIGHTNESS, BRIGHTNESS_RAMP_TIME);
 
 void setup() {
   // Serial.begin(115200);
+  if (loopWatchdog.setup()) {
+    reportStall();
+  }
   esc.setup();
   balanceBeeper.setup();
-
-  FastLED.addLeds<WS2812B, FORWARD_PIN, GRB>(forward_leds, NUM_LEDS)
-      .setCorrection(TypicalLEDStrip);
-  FastLED.addLeds<WS2812B, REVERSE_PIN, GRB>(reverse_leds, NUM_LEDS)
-      .setCorrection(TypicalLEDStrip);
+#if OLED_DASHBOARD
+  setupDashboard();
+#endif
+
+#if PARALLEL_LED_OUTPUT && defined(FASTLED_AVR)
+  FastLED.addLeds(&ledOutput, leds, NUM_LEDS)
+      .setCorrection(TypicalLEDStrip)
+      .setPowerCached();
+#else
+  FastLED.addLeds(&forwardOutput, forward_leds, NUM_LEDS)
+      .setCorrection(TypicalLEDStrip)
+      .setPowerCached();
+  FastLED.addLeds(&reverseOutput, reverse_leds, NUM_LEDS)
+      .setCorrection(TypicalLEDStrip)
+      .setPowerCached();
+#endif
 
   FastLED.setMaxPowerInVoltsAndMilliamps(5, 1500);
-  FastLED.setBrightness(STARTUP_BRIGHTNESS);
+  FastLED.setBrightness(brightnessRamp.get());
   FastLED.clear();
 
-  // Initial LED pattern
-  for (int i = 0; i < NUM_LEDS; i++) {
-    forward_leds[i] = CRGB(FLASHING_LED_RED, FLASHING_LED_GREEN, FLASHING_LED_BLUE);
-    reverse_leds[i] = (i % 2 == 0)
-        ? CRGB(CONSTANT_LED_RED, CONSTANT_LED_GREEN, CONSTANT_LED_BLUE)
-        : CRGB(0, 0, 0);
-  }
-
-  startupBeginMS = millis();
+  rideState.update(telemetry); // Boot -> startup animation
 
+  renderFrame();
   FastLED.show();
+
+  loopWatchdog.endSetup();
 }
 
 void loop() {
+  loopWatchdog.beginLoop();
   
   // Passive listenin for status 6;
-  esc.listenForMessages();
+  loopWatchdog.setStage(STAGE_CAN_LISTEN);
+  bool telemetryUpdated = esc.listenForMessages();
 
   // === Periodic CAN polling ===
   if (millis() - lastCanPollTime >= CAN_POLLING_INTERVAL) {
-    esc.getRealtimeData();      // send request for realtime data
+    loopWatchdog.setStage(STAGE_CAN_POLL);
+    if (esc.getRealtimeData()) { // send request for realtime data
+      telemetryUpdated = true;
+    }
 
     lastCanPollTime = millis();
 
@@ -152,304 +247,231 @@ void loop() {
   }
 
   // === Use global data ===
-  balanceBeeper.loop(globalDutyCycle, globalErpm, globalVoltage);
-
-  // === Determine direction and state ===
-  if (globalErpm > 200) {
-    startupState = false;
-    movingState = true;
-    direction = FORWARD;
-    FastLED.setBrightness(NORMAL_BRIGHTNESS);
-  } else if (globalErpm < -200) {
-    startupState = false;
-    movingState = true;
-    direction = REVERSE;
-    FastLED.setBrightness(NORMAL_BRIGHTNESS);
-  } else {
-    if (movingState && !startupState)
-    {
-      returningToStartup = true;
-    }
-    startupState = true;
-    movingState = false;
-    FastLED.setBrightness(STARTUP_BRIGHTNESS);
+  // The duty cycle comes straight from the last STATUS frame, the globals are
+  // only refreshed every CAN_POLLING_INTERVAL and would delay the warning
+  loopWatchdog.setStage(STAGE_BEEPER);
+  balanceBeeper.loop(esc.dutyCycle, globalErpm, globalVoltage);
+
+  // === Brake logic, runs once per received erpm sample ===
+  if (esc.erpmUpdated) {
+    esc.erpmUpdated = false;
+    brakeDetector.addSample(esc.erpm, esc.erpmMillis);
   }
 
-  // === LED patterns ===
-  if (startupState) {
-    processStartupAction();
-  } else if (movingState) {
-    knightRider(FLASHING_LED_RED, FLASHING_LED_GREEN, FLASHING_LED_BLUE, 5);
+  // === Battery level, filtered once per received voltage sample ===
+  if (esc.voltageUpdated) {
+    esc.voltageUpdated = false;
+    batteryGauge.addSample(esc.voltage, esc.dutyCycle);
   }
 
-  // === Brake logic ===
-  if (millis() - lastBrakeCheckMillis >= brakeCheckInterval) {
-    checkBraking();
-    lastBrakeCheckMillis = millis();
+  // === Ride state, only evaluated on new data or when its timer runs out ===
+  if (telemetryUpdated || rideState.timerExpired()) {
+    loopWatchdog.setStage(STAGE_RIDE_STATE);
+    telemetry.erpm = esc.erpm;
+    telemetry.voltage = esc.voltage;
+    telemetry.dutyCycle = esc.dutyCycle;
+    telemetry.batteryLevel = batteryGauge.getLevel();
+    telemetry.footpad1 = esc.adc1 > esc.footpadThreshold;
+    telemetry.footpad2 = esc.adc2 > esc.footpadThreshold;
+    telemetry.braking = brakeDetector.isBraking();
+    rideState.update(telemetry);
+    forwardStrip.telemetryChanged();
+    reverseStrip.telemetryChanged();
   }
 
-  // === Throttled LED update ===
+  // === Throttled LED update, frames are rendered from time so skipping one is harmless ===
   if (millis() - lastLEDUpdateMillis >= LED_UPDATE_INTERVAL) {
-    FastLED.show();
+    loopWatchdog.setStage(STAGE_RENDER);
+    if (renderFrame()) {
+      loopWatchdog.setStage(STAGE_SHOW);
+      FastLED.show();
+    }
     lastLEDUpdateMillis = millis();
   }
-}
 
-void checkBraking() {
-  static int debounceOnCount = 0;
-  static int debounceOffCount = 0;
-  int erpmDifference = previousErpm - globalErpm;
-
-  if ((direction == FORWARD && erpmDifference > BRAKE_THRESHOLD && globalErpm > BRAKE_IDLE_THRESHOLD) ||
-      (direction == REVERSE && erpmDifference < -BRAKE_THRESHOLD && globalErpm < -BRAKE_IDLE_THRESHOLD)) {
-    debounceOnCount++;
-    debounceOffCount = 0;
-    if (debounceOnCount >= BRAKE_ON_DEBOUNCE_COUNT) {
-      isBraking = true;
-      debounceOnCount = 0;
-    }
-  } else {
-    debounceOffCount++;
-    debounceOnCount = 0;
-    if (debounceOffCount >= BRAKE_OFF_DEBOUNCE_COUNT) {
-      isBraking = false;
-      debounceOffCount = 0;
-    }
+#if OLED_DASHBOARD
+  // === Dashboard, changed characters are queued and sent in short slices ===
+  loopWatchdog.setStage(STAGE_DASHBOARD);
+  if (millis() - lastDashboardMillis >= DASHBOARD_UPDATE_INTERVAL) {
+    updateDashboardValues();
+    lastDashboardMillis = millis();
   }
-
-  previousErpm = globalErpm;
-
-  CRGB *leds_const = (direction == FORWARD) ? reverse_leds : forward_leds;
-  if (isBraking) {
-    for (int i = 0; i < NUM_LEDS; i++) {
-      leds_const[i].setRGB(CONSTANT_LED_RED, CONSTANT_LED_GREEN, CONSTANT_LED_BLUE);
-    }
-  } else {
-    for (int i = 0; i < NUM_LEDS; i++) {
-      if (i % 2 == 0)
-        leds_const[i].setRGB(CONSTANT_LED_RED, CONSTANT_LED_GREEN, CONSTANT_LED_BLUE);
-      else
-        leds_const[i] = CRGB(0, 0, 0);
-    }
+  if (oled.queuedBytes() == 0 && millis() - lastTickerMillis >= DASHBOARD_TICKER_INTERVAL) {
+    tickLowBatteryBanner();
+    lastTickerMillis = millis();
   }
+  // Only as much as the queue takes, so drawing never waits for the bus
+  dashboard.update(oled.queueFree());
+  unsigned long sliceStart = micros();
+  oled.sendQueued(DASHBOARD_SLICE_MICROS);
+  longestI2cSlice = max(longestI2cSlice, micros() - sliceStart);
+#endif
 }
 
-void knightRider(int red, int green, int blue, int ridingWidth) {
-  // Select correct LED array based on drive direction
-  CRGB *leds = (direction == FORWARD) ? forward_leds : reverse_leds;
-  if (!leds) return;
-
-  // === Stop animation when idle ===
-  const long IDLE_ERPM = 200; // below this, animation stops
-  if (abs(globalErpm) < IDLE_ERPM) {
-    // Smooth fade out when idle
-    for (int i = 0; i < NUM_LEDS; i++) {
-      leds[i].fadeToBlackBy(40);
-    }
-    FastLED.show();
-    return;
-  }
-
-  // === Calculate delay based on ERPM ===
-  long erpm = abs(globalErpm);
-  unsigned long delayDuration = (unsigned long)map(erpm, 200, 20000, 80, 5);
-  delayDuration = constrain(delayDuration, 5UL, 250UL);
-
-  // === Time to update ===
-  if (millis() - lastKnightRiderUpdate >= delayDuration) {
-
-    // Slightly dim all LEDs to create a smooth trail
-    for (int i = 0; i < NUM_LEDS; i++) {
-      leds[i].fadeToBlackBy(60);
-    }
-
-    // Ensure current index stays valid
-    currentLEDIndex = constrain(currentLEDIndex, 0, NUM_LEDS - ridingWidth - 2);
-
-    // --- Draw the moving bright segment with soft edges ---
-    for (int j = -2; j < ridingWidth + 2; j++) {
-      int idx = currentLEDIndex + j;
-      if (idx >= 0 && idx < NUM_LEDS) {
-        int fadeFactor;
-        if (j < 0 || j >= ridingWidth) fadeFactor = 30;     // soft edge glow
-        else fadeFactor = 100;                              // main bright part
-      
-        leds[idx].setRGB(
-          (red   * fadeFactor) / 100,
-          (green * fadeFactor) / 100,
-          (blue  * fadeFactor) / 100
-        );
-      }
-    }
-  
-    // --- Move the light bar ---
-    currentLEDIndex += animationDirFlag;
-
-    // --- Bounce when reaching edges ---
-    if (currentLEDIndex >= NUM_LEDS - ridingWidth - 2) {
-      animationDirFlag = -1;
-    } else if (currentLEDIndex <= 0) {
-      animationDirFlag = 1;
-    }
+#ifdef __AVR__
+// Watchdog timeout, the next timeout resets the board
+ISR(WDT_vect) {
+  loopWatchdog.saveStallRecord(esc.lastCanId);
+}
 
-    FastLED.show();
-    lastKnightRiderUpdate = millis();
-  }
+// Steps through the notes of the beeper once per millisecond
+ISR(TIMER0_COMPA_vect) {
+  balanceBeeper.onTick();
 }
 
-void processStartupAction() {
-   // Reset voltage acquired flag when returning to startup
-  if (returningToStartup) {
-    voltageAcquired = false;
-    returningToStartup = false;
-  }
+// Toggles the buzzer pin at the note frequency
+ISR(TIMER2_COMPA_vect) {
+  balanceBeeper.onToggle();
+}
+#endif
+
+// Report the stall that caused the last reset
+void reportStall() {
+  const StallRecord &stall = loopWatchdog.getLastStall();
+  Serial.begin(115200);
+  Serial.print(F("Stall in stage "));
+  Serial.print(stall.stage);
+  Serial.print(F(", last CAN id 0x"));
+  Serial.print(stall.canId, HEX);
+  Serial.print(F(", at "));
+  Serial.print(stall.timestamp);
+  Serial.println(F(" ms"));
+}
 
-  // Show startup loading animation if not complete
-  if (!startupAnimationComplete) {
-    startupAnimation();
-    return; // Don't proceed with other startup logic during animation
-  }
-  
-  // Acquire voltage and start timer when voltage becomes available
-  if (!voltageAcquired && globalVoltage != 0.0) {
-    voltageAcquired = true;
-    voltageAcquiredMS = millis();
-  }
+#if OLED_DASHBOARD
+void setupDashboard() {
+  Wire.begin();
+  Wire.setClock(400000L);
+  oled.begin(&Adafruit128x64, OLED_I2C_ADDRESS);
+  oled.setFont(System5x7);
+  oled.clear();
+  voltageField = dashboard.addField(0, 0, F("Volt "), 5, DASHBOARD_DIGITS);
+  erpmField = dashboard.addField(0, 3, F("ERPM "), 6);
+  dutyField = dashboard.addField(0, 4, F("Duty "), 4);
+  footpadField = dashboard.addField(0, 5, F("Pads "), 2);
+  i2cTimeField = dashboard.addField(0, 7, F("I2C us "), 5);
+  // CAN frames lost to MCP2515 receive buffer overflows
+  droppedFramesField = dashboard.addField(78, 7, F("Drp "), 4);
+  // Loop passes over LOOP_DEADLINE, the longest pass in ms and the stage
+  // the last overrun ended in
+  overrunField = dashboard.addField(72, 3, F("Ovr "), 4);
+  longestLoopField = dashboard.addField(72, 4, F("Max "), 4);
+  overrunStageField = dashboard.addField(72, 5, F("Stg "), 2);
+  oled.tickerInit(&lowBatteryTicker, System5x7, 6, false, 0, 127, true);
+}
 
-  // Check if both footpad sensors were triggered
-  if (esc.adc1 > esc.footpadThreshold && esc.adc2 > esc.footpadThreshold) {
-    lastFootpadTriggerMillis = millis();
-    isInitialStartup = false;
+// Keeps the warning going while the battery is low, once it isn't the text
+// runs out of the row. Nothing is shown before the gauge has a voltage.
+void tickLowBatteryBanner() {
+  if (batteryGauge.hasReading() && telemetry.batteryLevel < DASHBOARD_LOW_BATTERY &&
+      lowBatteryTicker.queueUsed() <= 1) {
+    oled.tickerText(&lowBatteryTicker, "LOW BATTERY   ");
   }
+  oled.tickerTick(&lowBatteryTicker);
+}
 
-  // Clear initial startup flag after duration expires
-  if (isInitialStartup && voltageAcquired && (millis() - voltageAcquiredMS > BATTERY_INDICATOR_DURATION)) {
-    isInitialStartup = false;  
-  }
+// Formats the latest telemetry into the fields, drawing happens in update()
+void updateDashboardValues() {
+  dashboard.setNumber(voltageField, lround(telemetry.voltage * 10), 1);
+  dashboard.setNumber(erpmField, telemetry.erpm);
+  dashboard.setNumber(dutyField, lround(telemetry.dutyCycle * 100));
+  char pads[3] = { telemetry.footpad1 ? 'L' : '-', telemetry.footpad2 ? 'R' : '-', 0 };
+  dashboard.setText(footpadField, pads);
+  dashboard.setNumber(i2cTimeField, longestI2cSlice);
+  dashboard.setNumber(overrunField, loopWatchdog.overrunCount);
+  dashboard.setNumber(longestLoopField, loopWatchdog.longestLoop);
+  dashboard.setNumber(overrunStageField, loopWatchdog.lastOverrunStage);
+  dashboard.setNumber(droppedFramesField, esc.droppedFrames);
+}
+#endif
 
-  // Determine if we should show battery
-  // Only show battery if voltage is acquired AND within timer window
-  bool showBatteryOnTimer = voltageAcquired && (millis() - voltageAcquiredMS <= BATTERY_INDICATOR_DURATION);
-  bool showBatteryOnFootpad = voltageAcquired && (millis() - lastFootpadTriggerMillis <= BATTERY_INDICATOR_DURATION);
-  
-  // Show battery only if voltage is acquired and within timer
-  if (showBatteryOnTimer) {
-    batteryPercentStartupLEDs();
-  }
-  // Else if footpad was triggered recently
-  else if (showBatteryOnFootpad) {
-    batteryPercentStartupLEDs();
-  }
-  // Else show static or single footpad indicator
-  else {
-    // Check if only one footpad is triggered 
-    bool onlyOneFootpad = (esc.adc1 > esc.footpadThreshold) != (esc.adc2 > esc.footpadThreshold);
-    
-    if (onlyOneFootpad) {
-      singleFootpadTriggeredStartupLEDs();
-    } else {
-      staticStartupLEDs();
-    }
+// Follows the brightness ramp, FastLED is only touched when the value changes
+void updateBrightness(unsigned long now) {
+  if (brightnessRamp.update(now)) {
+    FastLED.setBrightness(brightnessRamp.get());
+    brightnessChanged = true;
   }
-} 
+}
 
-void startupAnimation() {
-  unsigned long elapsed = millis() - startupBeginMS;
-  
-  if (elapsed >= STARTUP_ANIMATION_DURATION) {
-    startupAnimationComplete = true;
-    return; // Animation complete, exit
-  }
-  
-  // Calculate how many LEDs should be lit based on progress
-  int numLeds = map(elapsed, 0, STARTUP_ANIMATION_DURATION, 0, NUM_LEDS);
-  numLeds = constrain(numLeds, 0, NUM_LEDS);
-  
-  // Light up forward LEDs progressively
-  for (int i = 0; i < NUM_LEDS; i++) {
-    if (i < numLeds) {
-      forward_leds[i] = CRGB(STARTUP_ANIMATION_LED_RED, STARTUP_ANIMATION_LED_GREEN, STARTUP_ANIMATION_LED_BLUE);
-    } else {
-      forward_leds[i] = CRGB(0, 0, 0);
-    }
+// Compose both strips, returns true if they need to be shown
+bool renderFrame() {
+  unsigned long now = millis();
+  updateBrightness(now);
+  bool changed = false;
+  // Only strips that were drawn get their power draw summed again
+  if (forwardStrip.render(now, telemetry, composedFrame, layerFrame)) {
+    forwardController.setDirty();
+    changed = true;
   }
-  
-  // Keep reverse LEDs in default pattern
-  for (int i = 0; i < NUM_LEDS; i++) {
-    reverse_leds[i] = (i % 2 == 0)
-        ? CRGB(CONSTANT_LED_RED, CONSTANT_LED_GREEN, CONSTANT_LED_BLUE)
-        : CRGB(0, 0, 0);
+  if (reverseStrip.render(now, telemetry, composedFrame, layerFrame)) {
+    reverseController.setDirty();
+    changed = true;
   }
+  changed |= brightnessChanged;
+  brightnessChanged = false;
+  return changed;
 }
 
-void staticStartupLEDs() {
-     // Static startup LEDs
-  for (int i = 0; i < NUM_LEDS; i++) {
-    if (direction == FORWARD) {
-      forward_leds[i] = CRGB(FLASHING_LED_RED, FLASHING_LED_GREEN, FLASHING_LED_BLUE);
-      reverse_leds[i] = (i % 2 == 0)
-          ? CRGB(CONSTANT_LED_RED, CONSTANT_LED_GREEN, CONSTANT_LED_BLUE)
-          : CRGB(0, 0, 0);
-    } else {
-      reverse_leds[i] = CRGB(FLASHING_LED_RED, FLASHING_LED_GREEN, FLASHING_LED_BLUE);
-      forward_leds[i] = (i % 2 == 0)
-          ? CRGB(CONSTANT_LED_RED, CONSTANT_LED_GREEN, CONSTANT_LED_BLUE)
-          : CRGB(0, 0, 0);
-    }
-  }
+LayeredStrip &headStrip() {
+  return (direction == FORWARD) ? forwardStrip : reverseStrip;
 }
 
-void batteryPercentStartupLEDs() {
-
-    if (!isInitialStartup) {
-    // Only check footpads after initial startup (when triggered by footpad press)
-    if (esc.adc1 < esc.footpadThreshold || esc.adc2 < esc.footpadThreshold) {
-      return;
-    }
-  }
-
-  // Get battery voltage
-  double batteryVoltage = globalVoltage;
-
-  // calculate the battery voltage to be a percentage of the difference between full voltage and low voltage
-  double batteryVoltagePercentage = (batteryVoltage - LOW_VOLTAGE) / (FULL_VOLTAGE - LOW_VOLTAGE);
+LayeredStrip &tailStrip() {
+  return (direction == FORWARD) ? reverseStrip : forwardStrip;
+}
 
-  //light up one led for each 10% of the battery voltage remaining and turn off the rest
-  for (int i = 0; i < NUM_LEDS; i++) {
-    if (i < batteryVoltagePercentage*NUM_LEDS) {
-      forward_leds[i].setRGB(BATTERY_INDICATOR_LED_RED, BATTERY_INDICATOR_LED_GREEN, BATTERY_INDICATOR_LED_BLUE);
-    } else {
-      forward_leds[i].setRGB(BATTERY_INDICATOR_ALTERNATE_LED_RED, BATTERY_INDICATOR_ALTERNATE_LED_GREEN, BATTERY_INDICATOR_ALTERNATE_LED_BLUE);
-    }
+void onRideStateEnter(RideState state) {
+  switch (state) {
+    case RIDE_STARTUP_ANIMATION:
+      brightnessRamp.setTarget(STARTUP_BRIGHTNESS);
+      forwardStrip.setLayer(LAYER_BASE, EFFECT_STARTUP);
+      reverseStrip.setLayer(LAYER_BASE, EFFECT_TAIL_LIGHT);
+      rideState.startTimer(STARTUP_ANIMATION_DURATION);
+      break;
+    case RIDE_IDLE:
+      brightnessRamp.setTarget(STARTUP_BRIGHTNESS);
+      headStrip().setLayer(LAYER_BASE, EFFECT_HEADLIGHT);
+      tailStrip().setLayer(LAYER_BASE, EFFECT_TAIL_LIGHT);
+      forwardStrip.clearLayer(LAYER_ANIMATION);
+      reverseStrip.clearLayer(LAYER_ANIMATION);
+      break;
+    case RIDE_BATTERY_GAUGE:
+      brightnessRamp.setTarget(STARTUP_BRIGHTNESS);
+      forwardStrip.setLayer(LAYER_ALERT, EFFECT_BATTERY_GAUGE);
+      rideState.startTimer(BATTERY_INDICATOR_DURATION);
+      break;
+    case RIDE_FOOTPAD_HINT:
+      brightnessRamp.setTarget(STARTUP_BRIGHTNESS);
+      forwardStrip.setLayer(LAYER_ALERT, EFFECT_FOOTPAD_HINT);
+      break;
+    case RIDE_MOVING_FORWARD:
+    case RIDE_MOVING_REVERSE:
+      brightnessRamp.setTarget(NORMAL_BRIGHTNESS);
+      direction = (state == RIDE_MOVING_FORWARD) ? FORWARD : REVERSE;
+      headStrip().setLayer(LAYER_BASE, EFFECT_OFF);
+      headStrip().setLayer(LAYER_ANIMATION, EFFECT_KNIGHT_RIDER);
+      tailStrip().setLayer(LAYER_BASE, EFFECT_TAIL_LIGHT);
+      tailStrip().clearLayer(LAYER_ANIMATION);
+      break;
+    case RIDE_BRAKING:
+      brightnessRamp.setTarget(NORMAL_BRIGHTNESS);
+      tailStrip().setLayer(LAYER_BRAKE, EFFECT_BRAKE_LIGHT);
+      break;
+    default:
+      break;
   }
 }
 
-void singleFootpadTriggeredStartupLEDs() {
-  
-  if (esc.adc1 > esc.footpadThreshold)
-  {
-    for (int i = 0; i < NUM_LEDS; i++)
-    {
-      if (i < NUM_LEDS/2){
-        forward_leds[i].setRGB(FOOTPAD_INDICATOR_LED_RED, FOOTPAD_INDICATOR_LED_GREEN, FOOTPAD_INDICATOR_LED_BLUE);
-      }
-      else {
-        forward_leds[i].setRGB(0, 0, 0);
-      }
-      
-    }
-  }
-  else
-  if (esc.adc2 > esc.footpadThreshold)
-  {
-    for (int i = 0; i < NUM_LEDS; i++)
-    {
-      if (i > NUM_LEDS/2){
-        forward_leds[i].setRGB(FOOTPAD_INDICATOR_LED_RED, FOOTPAD_INDICATOR_LED_GREEN, FOOTPAD_INDICATOR_LED_BLUE);
-      }
-      else {
-        forward_leds[i].setRGB(0, 0, 0);
-      }
-    }
+void onRideStateExit(RideState state) {
+  switch (state) {
+    case RIDE_BATTERY_GAUGE:
+    case RIDE_FOOTPAD_HINT:
+      forwardStrip.clearLayer(LAYER_ALERT);
+      break;
+    case RIDE_BRAKING:
+      tailStrip().clearLayer(LAYER_BRAKE);
+      break;
+    default:
+      break;
   }
-}
\ No newline at end of file
+}
@@ -0,0 +1,62 @@
+#include <FastLED.h>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Gamma benchmark
+//
+// Compares the float pow() based napplyGamma_video( leds, count, gamma) with the
+// lookup table version napplyGamma_video<GAMMA_X10>( leds, count) and checks that
+// both produce the same values.  Results are printed on the serial monitor at 115200.
+//
+// No leds need to be connected.  host/gamma_benchmark_host.cpp does the same comparison on a PC.
+
+#define NUM_LEDS 144
+#define ROUNDS 20
+
+CRGB leds[NUM_LEDS];
+
+void fillTestPattern(uint8_t round) {
+    for( int i = 0; i < NUM_LEDS; i++) {
+        leds[i] = CRGB( i + round, i * 3, 255 - i);
+    }
+}
+
+void setup() {
+    Serial.begin(115200);
+    while( !Serial) { }
+
+    uint32_t powMicros = 0;
+    uint32_t lutMicros = 0;
+    uint16_t mismatches = 0;
+    CRGB reference[NUM_LEDS];
+
+    for( uint8_t round = 0; round < ROUNDS; round++) {
+        fillTestPattern( round);
+        uint32_t start = micros();
+        napplyGamma_video( leds, NUM_LEDS, 2.2);
+        powMicros += micros() - start;
+        memcpy( reference, leds, sizeof(leds));
+
+        fillTestPattern( round);
+        start = micros();
+        napplyGamma_video<22>( leds, NUM_LEDS);
+        lutMicros += micros() - start;
+
+        for( int i = 0; i < NUM_LEDS; i++) {
+            if( leds[i] != reference[i]) {
+                mismatches++;
+            }
+        }
+    }
+
+    Serial.print( F("pow():  "));
+    Serial.print( powMicros / ROUNDS);
+    Serial.println( F(" us per frame"));
+    Serial.print( F("table:  "));
+    Serial.print( lutMicros / ROUNDS);
+    Serial.println( F(" us per frame"));
+    Serial.print( F("mismatching pixels: "));
+    Serial.println( mismatches);
+}
+
+void loop() { }
@@ -0,0 +1,100 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Gamma benchmark, host version
+//
+// Same comparison as GammaBenchmark.ino, built for the PC so the lookup tables can be checked
+// and timed without a board.  The tables come from the library's colorutils.h, the reference
+// is the float pow() formula of applyGamma_video().  Build and run from this directory:
+//
+//   g++ -std=gnu++11 -O2 gamma_benchmark_host.cpp -o gamma_benchmark_host
+//   ./gamma_benchmark_host
+//
+// The Arduino IDE doesn't compile this folder with the sketch.
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+
+// Just enough of the platform layer for colorutils.h, FastLED.h itself needs a board
+#define __INC_FASTSPI_LED2_H
+#define __INC_LED_SYSDEFS_H
+#define __INC_FL_PROGMEM_H
+#define FASTLED_NAMESPACE_BEGIN
+#define FASTLED_NAMESPACE_END
+#define FASTLED_USING_NAMESPACE
+#define FL_PROGMEM
+#define FL_PGM_READ_BYTE_NEAR(x)  (*((const  uint8_t*)(x)))
+#define FL_PGM_READ_WORD_NEAR(x)  (*((const uint16_t*)(x)))
+#define FL_PGM_READ_DWORD_NEAR(x) (*((const uint32_t*)(x)))
+#include "../../../src/colorutils.h"
+
+#define NUM_LEDS 144
+#define ROUNDS 20000
+
+CRGB leds[NUM_LEDS];
+CRGB reference[NUM_LEDS];
+
+// applyGamma_video( brightness, gamma) from colorutils.cpp
+uint8_t powGamma( uint8_t brightness, float gamma) {
+    float adj = pow( (float)(brightness) / (255.0), gamma) * (255.0);
+    uint8_t result = (uint8_t)(adj);
+    if( (brightness > 0) && (result == 0)) {
+        result = 1;
+    }
+    return result;
+}
+
+void fillTestPattern( uint16_t round) {
+    for( int i = 0; i < NUM_LEDS; i++) {
+        leds[i] = CRGB( i + round, i * 3, 255 - i);
+    }
+}
+
+double microsSince( std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::micro>( std::chrono::steady_clock::now() - start).count();
+}
+
+template<uint8_t GAMMA_X10>
+int bench() {
+    // volatile keeps the compiler from turning pow( x, 1.0) or pow( x, 2.0) into a multiply
+    volatile float gamma = GAMMA_X10 / 10.0f;
+    double powMicros = 0;
+    double lutMicros = 0;
+    uint32_t checksum = 0;
+    for( uint16_t round = 0; round < ROUNDS; round++) {
+        fillTestPattern( round);
+        auto start = std::chrono::steady_clock::now();
+        for( int i = 0; i < NUM_LEDS; i++) {
+            leds[i].r = powGamma( leds[i].r, gamma);
+            leds[i].g = powGamma( leds[i].g, gamma);
+            leds[i].b = powGamma( leds[i].b, gamma);
+        }
+        powMicros += microsSince( start);
+        memcpy( reference, leds, sizeof(leds));
+
+        fillTestPattern( round);
+        start = std::chrono::steady_clock::now();
+        napplyGamma_video<GAMMA_X10>( leds, NUM_LEDS);
+        lutMicros += microsSince( start);
+        checksum += leds[round % NUM_LEDS].r;
+    }
+
+    // Every input value, not just the ones in the pattern
+    int mismatches = 0;
+    for( int i = 0; i < 256; i++) {
+        if( applyGamma8_video<GAMMA_X10>( i) != powGamma( i, gamma)) {
+            mismatches++;
+        }
+    }
+
+    printf( "gamma %.1f: pow() %.2f us, table %.2f us per frame of %d leds, %d of 256 entries differ (%u)\n",
+            (double)gamma, powMicros / ROUNDS, lutMicros / ROUNDS, NUM_LEDS, mismatches, (unsigned)checksum);
+    return mismatches;
+}
+
+int main() {
+    int mismatches = bench<10>() + bench<20>() + bench<22>() + bench<25>() + bench<28>();
+    return mismatches ? 1 : 0;
+}
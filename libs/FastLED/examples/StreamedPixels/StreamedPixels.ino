@@ -0,0 +1,82 @@
+#include <FastLED.h>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Streamed pixels benchmark
+//
+// Drives a long WS2812B strip from one byte per led with AVRStreamClocklessController, and
+// measures on the board how long the line is held low between bytes while the next led is
+// fetched.  Timer1 keeps counting with interrupts off, so it times the whole frame:
+//
+//  - a frame of one color gives the cost of scaling and spreading the bits of every byte
+//  - a frame from the indexed source and one from a callback add the fetch of every led
+//
+// The longest gap (before the first byte of a led) has to stay below FASTLED_MAX_LOW_GAP_US,
+// 5us, some clone leds latch after about 6us.  Results are printed on the serial monitor at 115200.
+// AVR only, the strip doesn't need to be connected.
+
+#define DATA_PIN 5
+#define NUM_LEDS 150
+#define GAP_LIMIT_US FASTLED_MAX_LOW_GAP_US
+
+uint8_t indexes[NUM_LEDS];
+CRGB colors[4] = { CRGB::Black, CRGB::Red, CRGB::Orange, CRGB::White };
+
+CIndexedPixelSource indexedSource(indexes, colors);
+AVRStreamClocklessController<DATA_PIN, C_NS(250), C_NS(625), C_NS(375), CIndexedPixelSource, GRB> indexedOutput(indexedSource);
+
+CRGB gradient(uint16_t index) {
+    return CRGB( index, 255 - index, 0);
+}
+
+CCallbackPixelSource callbackSource(gradient);
+AVRStreamClocklessController<DATA_PIN, C_NS(250), C_NS(625), C_NS(375), CCallbackPixelSource, GRB> callbackOutput(callbackSource);
+
+// Frame time in timer1 ticks of 0.5us
+uint16_t timeFrame(CLEDController & output, bool oneColor) {
+    delay(1); // let the latch wait of the last frame pass
+    TCCR1A = 0;
+    TCCR1B = (1 << CS11);
+    TCNT1 = 0;
+    if( oneColor) {
+        output.showColor( CRGB::White, 255);
+    } else {
+        output.showLeds( 255);
+    }
+    return TCNT1;
+}
+
+void setup() {
+    Serial.begin(115200);
+    while( !Serial) { }
+
+    for( int i = 0; i < NUM_LEDS; i++) {
+        indexes[i] = i & 3;
+    }
+    FastLED.addLeds( &indexedOutput, NULL, NUM_LEDS);
+    FastLED.addLeds( &callbackOutput, NULL, NUM_LEDS);
+
+    // 24 bits of 20 cycles at 16MHz per led is 30us, 60 ticks
+    uint32_t ideal = (uint32_t)NUM_LEDS * 60;
+    uint32_t plain = timeFrame( indexedOutput, true);
+    uint32_t indexed = timeFrame( indexedOutput, false);
+    uint32_t callback = timeFrame( callbackOutput, false);
+
+    // Ticks are half microseconds
+    float byteGap = (plain - ideal) / (2.0 * 3 * NUM_LEDS);
+    float indexedGap = byteGap + (indexed - plain) / (2.0 * NUM_LEDS);
+    float callbackGap = byteGap + (callback - plain) / (2.0 * NUM_LEDS);
+
+    Serial.print( F("gap between bytes:      "));
+    Serial.print( byteGap);
+    Serial.println( F(" us"));
+    Serial.print( F("gap with indexed fetch:  "));
+    Serial.print( indexedGap);
+    Serial.println( F(" us"));
+    Serial.print( F("gap with callback fetch: "));
+    Serial.print( callbackGap);
+    Serial.println( F(" us"));
+    Serial.println( (indexedGap < GAP_LIMIT_US && callbackGap < GAP_LIMIT_US) ? F("timing ok") : F("gaps too long"));
+}
+
+void loop() { }
@@ -0,0 +1,125 @@
+#include <FastLED.h>
+#include <EEPROM.h>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// USART output latency
+//
+// Measures how long an interrupt has to wait while a frame goes out, once with the clockless
+// driver and once with ClocklessUSARTController.  Timer1 fires a compare interrupt 100us after
+// the last one and reads how far it has counted past the match, the longest wait of each run
+// is kept.  The clockless driver blocks interrupts for the whole frame, the USART controller
+// only for the bytes it queues from its own interrupt.  underruns() tells whether the refills
+// kept up.
+//
+// The USART owns TXD (pin 1) and XCK (pin 4) in SPI mode and its interrupt vector is defined
+// here, so Serial can't be used in the same build.  The sketch runs in two steps:
+//   1. Upload with READ_RESULTS 0.  The results are stored in EEPROM and the builtin led
+//      lights up when they are.
+//   2. Upload with READ_RESULTS 1 and open the serial monitor at 115200 to print them.
+// AVR at 16MHz only, the strips don't need to be connected.
+
+#define READ_RESULTS 0
+
+#define CLOCKLESS_PIN 6
+#define NUM_LEDS 60
+#define FRAMES 100
+#define PERIOD_TICKS 200 // timer1 ticks of 0.5us between interrupts
+
+#define RESULTS_ADDRESS 0
+#define RESULTS_MAGIC 0x5A17
+
+struct Results {
+    uint16_t magic;
+    uint16_t frames;
+    uint16_t clocklessWait; // timer1 ticks
+    uint16_t usartWait;     // timer1 ticks
+    uint16_t underruns;
+};
+
+#if READ_RESULTS
+
+void setup() {
+    Serial.begin(115200);
+    while( !Serial) { }
+
+    Results results;
+    EEPROM.get( RESULTS_ADDRESS, results);
+    if( results.magic != RESULTS_MAGIC) {
+        Serial.println( F("no results stored, upload with READ_RESULTS 0 first"));
+        return;
+    }
+    Serial.print( F("longest interrupt wait, clockless: "));
+    Serial.print( results.clocklessWait / 2.0);
+    Serial.println( F(" us"));
+    Serial.print( F("longest interrupt wait, USART:     "));
+    Serial.print( results.usartWait / 2.0);
+    Serial.println( F(" us"));
+    Serial.print( F("USART underruns in "));
+    Serial.print( results.frames);
+    Serial.print( F(" frames: "));
+    Serial.println( results.underruns);
+}
+
+#else
+
+CRGB leds[NUM_LEDS];
+
+ClocklessUSARTController<GRB, NUM_LEDS> usartOutput;
+
+ISR(USART_UDRE_vect) { ClocklessUSARTController<GRB, NUM_LEDS>::onDataRegisterEmpty(); }
+
+volatile uint16_t longestWait = 0; // timer1 ticks
+
+// The timer runs free, so a wait longer than the period is still measured
+ISR(TIMER1_COMPA_vect) {
+    uint16_t now = TCNT1;
+    uint16_t wait = now - OCR1A;
+    if( wait > longestWait) {
+        longestWait = wait;
+    }
+    OCR1A = now + PERIOD_TICKS;
+}
+
+// Longest interrupt wait in timer1 ticks while FRAMES frames are sent
+uint16_t measure(CLEDController & output) {
+    TCCR1A = 0;
+    TCCR1B = (1 << CS11);
+    TCNT1 = 0;
+    OCR1A = PERIOD_TICKS;
+    TIFR1 = (1 << OCF1A);
+    cli();
+    longestWait = 0;
+    sei();
+    TIMSK1 = (1 << OCIE1A);
+    for( uint16_t frame = 0; frame < FRAMES; frame++) {
+        fill_rainbow( leds, NUM_LEDS, frame);
+        output.showLeds( 255);
+    }
+    while( ClocklessUSARTController<GRB, NUM_LEDS>::busy()) { }
+    TIMSK1 = 0;
+    cli();
+    uint16_t wait = longestWait;
+    sei();
+    return wait;
+}
+
+void setup() {
+    CLEDController & clocklessOutput = FastLED.addLeds<WS2812, CLOCKLESS_PIN, GRB>( leds, NUM_LEDS);
+    FastLED.addLeds( &usartOutput, leds, NUM_LEDS);
+
+    Results results;
+    results.magic = RESULTS_MAGIC;
+    results.frames = FRAMES;
+    results.clocklessWait = measure( clocklessOutput);
+    results.usartWait = measure( usartOutput);
+    results.underruns = ClocklessUSARTController<GRB, NUM_LEDS>::underruns();
+    EEPROM.put( RESULTS_ADDRESS, results);
+
+    pinMode( LED_BUILTIN, OUTPUT);
+    digitalWrite( LED_BUILTIN, HIGH);
+}
+
+#endif
+
+void loop() { }
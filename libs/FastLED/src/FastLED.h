@@ -57,6 +57,7 @@
 #include "hsv2rgb.h"
 #include "colorutils.h"
 #include "pixelset.h"
+#include "pixelsource.h"
 #include "colorpalettes.h"
 
 #include "noise.h"
@@ -7,8 +7,8 @@ void transpose8x1_noinline(unsigned char *A, unsigned char *B) {
     uint32_t x, y, t;
 
     // Load the array and pack it into x and y.
-    y = *(unsigned int*)(A);
-    x = *(unsigned int*)(A+4);
+    y = *(uint32_t*)(A);
+    x = *(uint32_t*)(A+4);
 
     // pre-transform x
     t = (x ^ (x >> 7)) & 0x00AA00AA;  x = x ^ t ^ (t << 7);
@@ -11,7 +11,7 @@ FASTLED_NAMESPACE_BEGIN
 ///@defgroup Bitswap Bit swapping/rotate
 ///Functions for doing a rotation of bits/bytes used by parallel output
 ///@{
-#if defined(FASTLED_ARM) || defined(FASTLED_ESP8266)
+#if defined(FASTLED_ARM) || defined(FASTLED_ESP8266) || defined(FASTLED_AVR)
 /// structure representing 8 bits of access
 typedef union {
   uint8_t raw;
@@ -176,8 +176,8 @@ __attribute__((always_inline)) inline void transpose8x1(unsigned char *A, unsign
   uint32_t x, y, t;
 
   // Load the array and pack it into x and y.
-  y = *(unsigned int*)(A);
-  x = *(unsigned int*)(A+4);
+  y = *(uint32_t*)(A);
+  x = *(uint32_t*)(A+4);
 
   // pre-transform x
   t = (x ^ (x >> 7)) & 0x00AA00AA;  x = x ^ t ^ (t << 7);
@@ -201,8 +201,8 @@ __attribute__((always_inline)) inline void transpose8x1_MSB(unsigned char *A, un
   uint32_t x, y, t;
 
   // Load the array and pack it into x and y.
-  y = *(unsigned int*)(A);
-  x = *(unsigned int*)(A+4);
+  y = *(uint32_t*)(A);
+  x = *(uint32_t*)(A+4);
 
   // pre-transform x
   t = (x ^ (x >> 7)) & 0x00AA00AA;  x = x ^ t ^ (t << 7);
@@ -235,11 +235,11 @@ __attribute__((always_inline)) inline void transpose8(unsigned char *A, unsigned
 
   // Load the array and pack it into x and y.
   if(m == 1) {
-    y = *(unsigned int*)(A);
-    x = *(unsigned int*)(A+4);
+    y = *(uint32_t*)(A);
+    x = *(uint32_t*)(A+4);
   } else {
-    x = (A[0]<<24)   | (A[m]<<16)   | (A[2*m]<<8) | A[3*m];
-    y = (A[4*m]<<24) | (A[5*m]<<16) | (A[6*m]<<8) | A[7*m];
+    x = ((uint32_t)A[0]<<24)   | ((uint32_t)A[m]<<16)   | ((uint32_t)A[2*m]<<8) | A[3*m];
+    y = ((uint32_t)A[4*m]<<24) | ((uint32_t)A[5*m]<<16) | ((uint32_t)A[6*m]<<8) | A[7*m];
   }
 
   // pre-transform x
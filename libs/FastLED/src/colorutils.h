@@ -1585,6 +1585,114 @@ void map_data_into_colors_through_palette(
 	}
 }
 
+// CRGBPaletteCache: the 256 colors of a palette, each looked up with
+//               ColorFromPalette the first time its index is used and kept
+//               until the palette, brightness or blend type changes.
+//
+//               Leds stored as one 8 bit index each plus this cache take a
+//               third of the ram of a CRGB array, and fading all of them is
+//               a single setBrightness() instead of a pass over every led.
+//               The cache itself takes 800 bytes plus the palette, so it
+//               pays off from about 400 leds, or when the same palette is
+//               shared by several strips.
+//
+//                 CRGBPaletteCache<CRGBPalette16> colors( pal);
+//                 map_data_into_colors_through_palette( indexes, NUM_LEDS, leds, colors);
+//
+//               expand() looks up all 256 colors at once, for the streamed
+//               output which can't wait for ColorFromPalette between leds:
+//
+//                 CIndexedPixelSource source( indexes, colors.expand());
+template <typename PALETTE>
+class CRGBPaletteCache {
+    PALETTE mPalette;
+    TBlendType mBlendType;
+    uint8_t mBrightness;
+    uint8_t mValid[32];  // one bit per index
+    CRGB mColors[256];
+
+public:
+    CRGBPaletteCache( const PALETTE& pal, TBlendType blendType=LINEARBLEND)
+        : mPalette( pal), mBlendType( blendType), mBrightness( 255)
+    {
+        invalidate();
+    }
+
+    // Switch palettes, the colors are only looked up again if it differs
+    void setPalette( const PALETTE& pal)
+    {
+        if( !(mPalette == pal)) {
+            mPalette = pal;
+            invalidate();
+        }
+    }
+
+    const PALETTE& getPalette() const { return mPalette; }
+
+    // Scale every color, e.g. to fade all leds using the palette at once
+    void setBrightness( uint8_t brightness)
+    {
+        if( brightness != mBrightness) {
+            mBrightness = brightness;
+            invalidate();
+        }
+    }
+
+    uint8_t getBrightness() const { return mBrightness; }
+
+    void setBlendType( TBlendType blendType)
+    {
+        if( blendType != mBlendType) {
+            mBlendType = blendType;
+            invalidate();
+        }
+    }
+
+    // Forget all colors, needed after changing the palette in place
+    void invalidate() { memset8( mValid, 0, sizeof( mValid)); }
+
+    const CRGB& operator[]( uint8_t index)
+    {
+        uint8_t& valid = mValid[index >> 3];
+        uint8_t bit = 1 << (index & 0x07);
+        if( !(valid & bit)) {
+            mColors[index] = ColorFromPalette( mPalette, index, mBrightness, mBlendType);
+            valid |= bit;
+        }
+        return mColors[index];
+    }
+
+    // Look up every color that isn't cached yet, the table stays valid until
+    // the next change
+    const CRGB* expand()
+    {
+        uint8_t index = 0;
+        do {
+            (*this)[index];
+        } while( ++index);
+        return mColors;
+    }
+};
+
+template <typename PALETTE>
+void map_data_into_colors_through_palette(
+	uint8_t *dataArray, uint16_t dataCount,
+	CRGB* targetColorArray,
+	CRGBPaletteCache<PALETTE>& colors,
+	uint8_t opacity=255)
+{
+	for( uint16_t i = 0; i < dataCount; ++i) {
+		CRGB rgb = colors[dataArray[i]];
+		if( opacity == 255 ) {
+			targetColorArray[i] = rgb;
+		} else {
+			targetColorArray[i].nscale8( 256 - opacity);
+			rgb.nscale8_video( opacity);
+			targetColorArray[i] += rgb;
+		}
+	}
+}
+
 // nblendPaletteTowardPalette:
 //               Alter one palette by making it slightly more like
 //               a 'target palette', used for palette cross-fades.
@@ -1685,7 +1793,8 @@ void nblendPaletteTowardPalette( CRGBPalette16& currentPalette,
 // e.g., "2.5", and as such these functions should not be called in
 // your innermost pixel loops, or in animations that are extremely
 // low on program storage space.  Nevertheless, if you need these
-// functions, here they are.
+// functions, here they are.  For per-frame use see the lookup table
+// versions (GammaTable, napplyGamma_video<GAMMA_X10>) below.
 //
 // Furthermore, bear in mind that CRGB leds have only eight bits
 // per channel of color resolution, and that very small, subtle shadings
@@ -1700,6 +1809,115 @@ void   napplyGamma_video( CRGB* rgbarray, uint16_t count, float gamma);
 void   napplyGamma_video( CRGB* rgbarray, uint16_t count, float gammaR, float gammaG, float gammaB);
 
 
+#if __cplusplus > 199711L
+// Compile-time gamma lookup tables
+//
+// GammaTable<GAMMA_X10, SCALE>::table is a 256-entry PROGMEM table holding
+// applyGamma_video( i, GAMMA_X10 / 10.0) for every i, scaled by SCALE/255.
+// The compiler computes the entries, so no pow() is called at runtime and
+// only the tables that are actually used take up flash.  SCALE folds a
+// white balance adjustment into the same lookup.
+//
+// Example: gamma 2.2 with the blue channel at 80%:
+//   napplyGamma_video<22, 255, 255, 204>( leds, NUM_LEDS);
+
+#ifndef FASTLED_GAMMA_X10
+#define FASTLED_GAMMA_X10 25
+#endif
+
+// constexpr math for the table generator, C++11 style single expressions
+constexpr double gamma8_exp_series( double x, uint8_t n, double term, double sum)
+{
+    return n > 20 ? sum : gamma8_exp_series( x, n + 1, term * x / n, sum + term * x / n);
+}
+
+constexpr double gamma8_square( double x) { return x * x; }
+
+// exp(x) = exp(x/16)^16 keeps the series short for the whole input range
+constexpr double gamma8_exp( double x)
+{
+    return gamma8_square( gamma8_square( gamma8_square( gamma8_square(
+        gamma8_exp_series( x / 16.0, 1, 1.0, 1.0)))));
+}
+
+// ln(m) = 2 * atanh((m-1)/(m+1)), fast for m in [0.5, 1]
+constexpr double gamma8_atanh_series( double y2, uint8_t k, double power, double sum)
+{
+    return k > 31 ? sum : gamma8_atanh_series( y2, k + 2, power * y2, sum + power * y2 / (k + 2));
+}
+
+constexpr double gamma8_ln_mantissa( double y)
+{
+    return 2.0 * gamma8_atanh_series( y * y, 1, y, y);
+}
+
+constexpr double gamma8_ln( double x, int8_t exponent)
+{
+    return x < 0.5 ? gamma8_ln( x * 2.0, exponent - 1)
+                   : gamma8_ln_mantissa( (x - 1.0) / (x + 1.0)) + exponent * 0.69314718055994531;
+}
+
+// The series can come out a hair below a whole result, e.g. every entry of
+// gamma 1.0, which would truncate to one less.  The epsilon is far below
+// the step between two inputs.
+constexpr double gamma8_scaled( uint8_t i, uint8_t gammaX10, uint8_t scale)
+{
+    return gamma8_exp( (gammaX10 / 10.0) * gamma8_ln( i / 255.0, 0)) * scale + 1e-6;
+}
+
+constexpr uint8_t gamma8_entry( uint8_t i, uint8_t gammaX10, uint8_t scale)
+{
+    return (i == 0 || scale == 0) ? 0
+         : ((uint8_t)gamma8_scaled( i, gammaX10, scale) == 0) ? 1
+         : (uint8_t)gamma8_scaled( i, gammaX10, scale);
+}
+
+template<uint8_t... I> struct gamma8_indices {};
+template<uint16_t N, uint8_t... I> struct gamma8_make_indices : gamma8_make_indices<N - 1, (uint8_t)(N - 1), I...> {};
+template<uint8_t... I> struct gamma8_make_indices<0, I...> { typedef gamma8_indices<I...> type; };
+
+template<uint8_t GAMMA_X10, uint8_t SCALE = 255, typename INDICES = typename gamma8_make_indices<256>::type>
+struct GammaTable;
+
+template<uint8_t GAMMA_X10, uint8_t SCALE, uint8_t... I>
+struct GammaTable<GAMMA_X10, SCALE, gamma8_indices<I...> > {
+    static const uint8_t table[256];
+};
+
+template<uint8_t GAMMA_X10, uint8_t SCALE, uint8_t... I>
+const uint8_t GammaTable<GAMMA_X10, SCALE, gamma8_indices<I...> >::table[256] FL_PROGMEM = {
+    gamma8_entry( I, GAMMA_X10, SCALE)...
+};
+
+// Table lookup version of applyGamma_video( brightness, GAMMA_X10 / 10.0)
+template<uint8_t GAMMA_X10 = FASTLED_GAMMA_X10>
+inline uint8_t applyGamma8_video( uint8_t brightness)
+{
+    return FL_PGM_READ_BYTE_NEAR( GammaTable<GAMMA_X10>::table + brightness);
+}
+
+// Gamma and white balance for a whole array in one pass, cheap enough to
+// run on every frame right before show().
+template<uint8_t GAMMA_X10 = FASTLED_GAMMA_X10, uint8_t SCALE_R = 255, uint8_t SCALE_G = 255, uint8_t SCALE_B = 255>
+void napplyGamma_video( CRGB* rgbarray, uint16_t count)
+{
+    // Gamma 1.0 without white balance leaves every value as it is
+    if( GAMMA_X10 == 10 && SCALE_R == 255 && SCALE_G == 255 && SCALE_B == 255) {
+        return;
+    }
+    const uint8_t* tableR = GammaTable<GAMMA_X10, SCALE_R>::table;
+    const uint8_t* tableG = GammaTable<GAMMA_X10, SCALE_G>::table;
+    const uint8_t* tableB = GammaTable<GAMMA_X10, SCALE_B>::table;
+    for( uint16_t i = 0; i < count; ++i) {
+        CRGB& rgb = rgbarray[i];
+        rgb.r = FL_PGM_READ_BYTE_NEAR( tableR + rgb.r);
+        rgb.g = FL_PGM_READ_BYTE_NEAR( tableG + rgb.g);
+        rgb.b = FL_PGM_READ_BYTE_NEAR( tableB + rgb.b);
+    }
+}
+#endif
+
+
 FASTLED_NAMESPACE_END
 
 ///@}
@@ -9,6 +9,7 @@
 #include "pixeltypes.h"
 #include "color.h"
 #include <stddef.h>
+#include <string.h>
 
 FASTLED_NAMESPACE_BEGIN
 
@@ -45,6 +46,9 @@ protected:
     CRGB m_ColorTemperature;
     EDitherMode m_DitherMode;
     int m_nLeds;
+    uint32_t m_nPower_mW;
+    bool m_bPowerCached;
+    bool m_bPowerDirty;
     static CLEDController *m_pHead;
     static CLEDController *m_pTail;
 
@@ -62,7 +66,7 @@ protected:
 
 public:
 	/// create an led controller object, add it to the chain of controllers
-    CLEDController() : m_Data(NULL), m_ColorCorrection(UncorrectedColor), m_ColorTemperature(UncorrectedTemperature), m_DitherMode(BINARY_DITHER), m_nLeds(0) {
+    CLEDController() : m_Data(NULL), m_ColorCorrection(UncorrectedColor), m_ColorTemperature(UncorrectedTemperature), m_DitherMode(BINARY_DITHER), m_nLeds(0), m_nPower_mW(0), m_bPowerCached(false), m_bPowerDirty(true) {
         m_pNext = NULL;
         if(m_pHead==NULL) { m_pHead = this; }
         if(m_pTail != NULL) { m_pTail->m_pNext = this; }
@@ -104,6 +108,7 @@ public:
     CLEDController & setLeds(CRGB *data, int nLeds) {
         m_Data = data;
         m_nLeds = nLeds;
+        m_bPowerDirty = true;
         return *this;
     }
 
@@ -111,6 +116,7 @@ public:
     void clearLedData() {
         if(m_Data) {
             memset8((void*)m_Data, 0, sizeof(struct CRGB) * m_nLeds);
+            m_bPowerDirty = true;
         }
     }
 
@@ -123,6 +129,14 @@ public:
     /// Reference to the n'th item in the controller
     CRGB &operator[](int x) { return m_Data[x]; }
 
+    /// keep the power draw of the leds between frames instead of summing the whole strip on every show.  Only
+    /// for sketches that call setDirty() after every change to the led data.
+    CLEDController & setPowerCached(bool cached = true) { m_bPowerCached = cached; m_bPowerDirty = true; return *this; }
+    /// mark the led data as changed since the last show, the power draw is summed again
+    void setDirty() { m_bPowerDirty = true; }
+    /// power draw of the leds at full brightness in milliwatts, recomputed is set when the leds had to be summed
+    virtual uint32_t getUnscaledPower_mW(bool & recomputed);
+
 	/// set the dithering mode for this controller to use
     inline CLEDController & setDither(uint8_t ditherMode = BINARY_DITHER) { m_DitherMode = ditherMode; return *this; }
     /// get the dithering option currently set for this controller
@@ -412,6 +426,73 @@ public:
     CPixelLEDController() : CLEDController() {}
 };
 
+/// LED controller that keeps a pre-encoded copy of its output.  The pixels are scaled (brightness, color correction
+/// and temperature) and reordered into wire order only when the led data or the scale changed, the wrapped controller
+/// then streams the encoded bytes unscaled.  Frames identical to the last one sent are skipped, with a full resend
+/// every RESEND_FRAMES shows so a glitched pixel doesn't stay wrong.  Dithering is not applied to the encoded output.
+///
+/// BASE is the chipset controller instantiated with RGB ordering, e.g.
+///     CEncodedLEDController<WS2812B<5, RGB>, GRB, NUM_LEDS> output;
+///     FastLED.addLeds(&output, leds, NUM_LEDS);
+///@tparam BASE the chipset controller, must use RGB ordering
+///@tparam RGB_ORDER the wire order of the leds
+///@tparam MAX_LEDS the size of the encoded buffer
+///@tparam RESEND_FRAMES number of skipped identical frames before the output is sent again, 0 never skips
+template<class BASE, EOrder RGB_ORDER, int MAX_LEDS, uint8_t RESEND_FRAMES = 64> class CEncodedLEDController : public BASE {
+    CRGB mSource[MAX_LEDS];
+    CRGB mEncoded[MAX_LEDS];
+    CRGB mScale;
+    int mEncodedLeds;
+    uint8_t mSkipped;
+
+    void encode(const struct CRGB *data, int nLeds, CRGB scale) {
+        uint8_t *out = (uint8_t*)mEncoded;
+        for(int i = 0; i < nLeds; ++i) {
+            const uint8_t *in = data[i].raw;
+            *out++ = scale8(in[RGB_BYTE0(RGB_ORDER)], scale.raw[RGB_BYTE0(RGB_ORDER)]);
+            *out++ = scale8(in[RGB_BYTE1(RGB_ORDER)], scale.raw[RGB_BYTE1(RGB_ORDER)]);
+            *out++ = scale8(in[RGB_BYTE2(RGB_ORDER)], scale.raw[RGB_BYTE2(RGB_ORDER)]);
+        }
+        memcpy(mSource, data, nLeds * sizeof(CRGB));
+        mScale = scale;
+        mEncodedLeds = nLeds;
+    }
+
+protected:
+    virtual void showColor(const struct CRGB & data, int nLeds, CRGB scale) {
+        // Not cached, the next show() is sent in full
+        mEncodedLeds = 0;
+        CRGB encoded;
+        encoded.raw[0] = scale8(data.raw[RGB_BYTE0(RGB_ORDER)], scale.raw[RGB_BYTE0(RGB_ORDER)]);
+        encoded.raw[1] = scale8(data.raw[RGB_BYTE1(RGB_ORDER)], scale.raw[RGB_BYTE1(RGB_ORDER)]);
+        encoded.raw[2] = scale8(data.raw[RGB_BYTE2(RGB_ORDER)], scale.raw[RGB_BYTE2(RGB_ORDER)]);
+        CRGB full(255, 255, 255);
+        PixelController<RGB> pixels(encoded, nLeds, full, DISABLE_DITHER);
+        BASE::showPixels(pixels);
+    }
+
+    virtual void show(const struct CRGB *data, int nLeds, CRGB scale) {
+        if(nLeds > MAX_LEDS) { nLeds = MAX_LEDS; }
+        bool changed = nLeds != mEncodedLeds || scale != mScale || memcmp(mSource, data, nLeds * sizeof(CRGB)) != 0;
+        if(changed) {
+            encode(data, nLeds, scale);
+        } else if(RESEND_FRAMES > 0 && ++mSkipped < RESEND_FRAMES) {
+            return;
+        }
+        mSkipped = 0;
+
+        CRGB full(255, 255, 255);
+        PixelController<RGB> pixels(mEncoded, nLeds, full, DISABLE_DITHER);
+        BASE::showPixels(pixels);
+    }
+
+public:
+    CEncodedLEDController() : BASE(), mEncodedLeds(0), mSkipped(0) {}
+
+    /// Force the next show() to encode and send the leds, e.g. after the strip was power cycled
+    void invalidate() { mEncodedLeds = 0; }
+};
+
 
 FASTLED_NAMESPACE_END
 
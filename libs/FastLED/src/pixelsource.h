@@ -0,0 +1,59 @@
+#ifndef __INC_PIXELSOURCE_H
+#define __INC_PIXELSOURCE_H
+
+#include "FastLED.h"
+
+///@file pixelsource.h
+/// Pixel sources, for controllers that fetch every led while it is being sent instead of reading a CRGB array.
+
+FASTLED_NAMESPACE_BEGIN
+
+///@defgroup PixelSources Pixel sources
+/// A pixel source hands out the leds of a strip one at a time.  It needs two members:
+///     void begin();   // called before the first led of a frame
+///     CRGB next();    // returns the next led
+/// next() runs between the bits on the wire, so it has to be quick: a table lookup or a few lines of math,
+/// not a full effect.
+///@{
+
+/// Pixel source reading one byte per led and looking the color up in a table of up to 256 colors.  The strip takes
+/// one byte of ram per led instead of three.  The table can be a fixed set of colors or CRGBPaletteCache::expand().
+class CIndexedPixelSource {
+	const uint8_t *mIndexes;
+	const uint8_t *mNext;
+	const CRGB *mColors;
+
+public:
+	/// @param indexes one color index per led
+	/// @param colors the color table, needs an entry for every index used
+	CIndexedPixelSource(const uint8_t *indexes, const CRGB *colors) : mIndexes(indexes), mNext(indexes), mColors(colors) {}
+
+	/// switch to another color table, e.g. to fade all leds at once
+	void setColors(const CRGB *colors) { mColors = colors; }
+	const CRGB *getColors() const { return mColors; }
+
+	inline void begin() { mNext = mIndexes; }
+	inline CRGB next() __attribute__((always_inline)) { return mColors[*mNext++]; }
+};
+
+/// Pixel source calling a function for every led, with the position of the led on the strip
+class CCallbackPixelSource {
+public:
+	typedef CRGB (*pixel_func)(uint16_t index);
+
+private:
+	pixel_func mFunc;
+	uint16_t mIndex;
+
+public:
+	CCallbackPixelSource(pixel_func func) : mFunc(func), mIndex(0) {}
+
+	inline void begin() { mIndex = 0; }
+	inline CRGB next() __attribute__((always_inline)) { return (*mFunc)(mIndex++); }
+};
+
+///@}
+
+FASTLED_NAMESPACE_END
+
+#endif
@@ -0,0 +1,167 @@
+#ifndef __INC_CLOCKLESS_BLOCK_AVR_H
+#define __INC_CLOCKLESS_BLOCK_AVR_H
+
+#include "../../controller.h"
+#include "../../lib8tion.h"
+#include "../../bitswap.h"
+#include "clockless_trinket.h"
+#include <avr/interrupt.h>
+
+FASTLED_NAMESPACE_BEGIN
+
+#if defined(FASTLED_AVR) && !defined(__AVR_ATmega4809__)
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Parallel clockless output for up to 8 strips on one AVR port.  The lanes are the pins FIRST_PIN .. FIRST_PIN+LANES-1,
+// which have to be consecutive bits of the same port (pins 0-7 are PD0-PD7 on the uno).  Every bit is clocked out to
+// all lanes at once: all lanes go high, the lanes sending a zero drop low after T1, the rest after T1+T2.  So n strips
+// take the time of one.
+//
+// The led data of the lanes is laid out one after the other, like the ARM block controllers:
+//     CRGB leds[LANES * NUM_LEDS];
+//     AVRBlockClocklessController<2, 5, C_NS(250), C_NS(625), C_NS(375), GRB> output;
+//     FastLED.addLeds(&output, leds, NUM_LEDS);
+//
+// The lane bytes of the next color are loaded, scaled and transposed into port values between bytes, which stretches
+// the low phase of every 8th bit (about 7us for two lanes at 16MHz, transpose8 for more lanes takes longer).  That is
+// above FASTLED_MAX_LOW_GAP_US (5us, see clockless_trinket.h), clone leds may take it as a reset and latch in the middle
+// of a frame.  It hasn't been checked on real strips yet, which is why the sketch leaves PARALLEL_LED_OUTPUT off.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <uint8_t LANES, uint8_t FIRST_PIN, int T1, int T2, int T3, EOrder RGB_ORDER = GRB, int WAIT_TIME = 50>
+class AVRBlockClocklessController : public CPixelLEDController<RGB_ORDER, LANES, 0xFF> {
+	static_assert(LANES >= 1 && LANES <= 8, "1 to 8 lanes");
+	static_assert(T1 >= 2 && T2 >= 2 && T3 >= 3, "Not enough cycles - use a higher clock speed");
+
+	typedef PixelController<RGB_ORDER, LANES, 0xFF> Pixels;
+	typedef typename FastPin<FIRST_PIN>::port_ptr_t data_ptr_t;
+	typedef typename FastPin<FIRST_PIN>::port_t data_t;
+
+	CMinWait<WAIT_TIME> mWait;
+
+// 1 cycle, write a value to the lanes
+#define BLOCK_OUT1(V) if((int)(FastPin<FIRST_PIN>::port())-0x20 < 64) { asm __volatile__("out %[PORT], %[v]" : : [PORT] "M" (FastPin<FIRST_PIN>::port() - 0x20), [v] "r" (V)); } else { *FastPin<FIRST_PIN>::port() = V; }
+
+// One bit on all lanes, V holds the lanes sending a one
+#define BLOCK_BIT(V) BLOCK_OUT1(hi) _dc<T1 - AVR_PIN_CYCLES(FIRST_PIN)>(loopvar); BLOCK_OUT1(V) _dc<T2 - AVR_PIN_CYCLES(FIRST_PIN)>(loopvar); BLOCK_OUT1(lo) _dc<T3 - AVR_PIN_CYCLES(FIRST_PIN)>(loopvar);
+
+	// Port values for the 8 bits of one color byte on every lane, MSB first
+	template<int PX> __attribute__((always_inline)) inline static void loadBits(Pixels & pixels, uint8_t lo, uint8_t shift, uint8_t *bits) {
+		uint8_t d = pixels.template getd<PX>(pixels);
+		uint8_t scale = pixels.template getscale<PX>(pixels);
+
+		if(LANES <= 2) {
+			// Spreading the bits directly is cheaper than a full transpose
+			uint8_t b0 = pixels.template loadAndScale<PX>(pixels, 0, d, scale);
+			uint8_t b1 = (LANES == 2) ? pixels.template loadAndScale<PX>(pixels, 1, d, scale) : 0;
+			uint8_t m0 = 1 << shift;
+			uint8_t m1 = 2 << shift;
+			for(uint8_t i = 0; i < 8; ++i) {
+				uint8_t v = lo;
+				if(b0 & 0x80) { v |= m0; }
+				if(b1 & 0x80) { v |= m1; }
+				bits[i] = v;
+				b0 <<= 1;
+				b1 <<= 1;
+			}
+		} else {
+			uint8_t lanes[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+			for(uint8_t i = 0; i < LANES; ++i) {
+				lanes[i] = pixels.template loadAndScale<PX>(pixels, i, d, scale);
+			}
+			// bits[i] holds bit 7-i of every lane, lane n in bit n
+			transpose8<1,1>(lanes, bits);
+			for(uint8_t i = 0; i < 8; ++i) {
+				bits[i] = lo | (bits[i] << shift);
+			}
+		}
+	}
+
+	__attribute__((always_inline)) inline static void writeBits(uint8_t *bits, uint8_t hi, uint8_t lo, uint8_t & loopvar) {
+		uint8_t v0 = bits[0], v1 = bits[1], v2 = bits[2], v3 = bits[3];
+		uint8_t v4 = bits[4], v5 = bits[5], v6 = bits[6], v7 = bits[7];
+		BLOCK_BIT(v0) BLOCK_BIT(v1) BLOCK_BIT(v2) BLOCK_BIT(v3)
+		BLOCK_BIT(v4) BLOCK_BIT(v5) BLOCK_BIT(v6) BLOCK_BIT(v7)
+	}
+
+	static void showRGBInternal(Pixels & pixels, uint8_t pinMask, uint8_t shift) {
+		data_ptr_t port = FastPin<FIRST_PIN>::port();
+		uint8_t hi = *port | pinMask;
+		uint8_t lo = *port & ~pinMask;
+		uint8_t loopvar = 0;
+		uint8_t bits[8];
+		*port = lo;
+
+		pixels.preStepFirstByteDithering();
+		while(pixels.has(1)) {
+			pixels.stepDithering();
+			loadBits<0>(pixels, lo, shift, bits);
+			writeBits(bits, hi, lo, loopvar);
+			loadBits<1>(pixels, lo, shift, bits);
+			writeBits(bits, hi, lo, loopvar);
+			loadBits<2>(pixels, lo, shift, bits);
+			writeBits(bits, hi, lo, loopvar);
+			pixels.advanceData();
+		}
+	}
+
+#undef BLOCK_BIT
+#undef BLOCK_OUT1
+
+	uint8_t mPinMask;
+	uint8_t mShift;
+
+	// Makes the pins of lanes L and up outputs, lanes past LANES never name a pin
+	template<uint8_t L, bool USED = (L < LANES)> struct Lane {
+		static void setOutput() { FastPin<FIRST_PIN + L>::setOutput(); Lane<L + 1>::setOutput(); }
+	};
+	template<uint8_t L> struct Lane<L, false> {
+		static void setOutput() { }
+	};
+
+public:
+	virtual int size() { return CLEDController::size() * LANES; }
+
+	virtual void init() {
+		Lane<0>::setOutput();
+		mShift = 0;
+		while(!(FastPin<FIRST_PIN>::mask() & (1 << mShift))) { ++mShift; }
+		mPinMask = ((1 << LANES) - 1) << mShift;
+	}
+
+	virtual uint16_t getMaxRefreshRate() const { return 400; }
+
+protected:
+	virtual void showPixels(Pixels & pixels) {
+		mWait.wait();
+		cli();
+
+		showRGBInternal(pixels, mPinMask, mShift);
+
+		// Adjust the timer, the same way as the single lane controller
+#if (!defined(NO_CORRECTION) || (NO_CORRECTION == 0)) && (FASTLED_ALLOW_INTERRUPTS == 0)
+		uint32_t microsTaken = (uint32_t)pixels.size() * (uint32_t)CLKS_TO_MICROS(24 * (T1 + T2 + T3));
+		// roughly 7us between bytes for loading and transposing the lanes
+		microsTaken += (uint32_t)pixels.size() * 3 * 7;
+		if(microsTaken > 1000) {
+			microsTaken -= 1000;
+			uint16_t x256ths = microsTaken >> 2;
+			x256ths += scale16by8(x256ths, 7);
+			x256ths += gTimeErrorAccum256ths;
+			MS_COUNTER += (x256ths >> 8);
+			gTimeErrorAccum256ths = x256ths & 0xFF;
+		}
+#endif
+
+		sei();
+		mWait.mark();
+	}
+};
+
+#endif
+
+FASTLED_NAMESPACE_END
+
+#endif
@@ -0,0 +1,156 @@
+#ifndef __INC_CLOCKLESS_STREAM_AVR_H
+#define __INC_CLOCKLESS_STREAM_AVR_H
+
+#include "../../controller.h"
+#include "../../lib8tion.h"
+#include "../../power_mgt.h"
+#include "clockless_trinket.h"
+#include <avr/interrupt.h>
+
+FASTLED_NAMESPACE_BEGIN
+
+#if defined(FASTLED_AVR) && !defined(__AVR_ATmega4809__)
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Clockless output without a CRGB array.  Every led is fetched from a pixel source (see pixelsource.h) right before it
+// is sent, so a strip only costs the ram the source needs: one byte per led for CIndexedPixelSource, nothing for a
+// CCallbackPixelSource.  That is what makes 100+ led strips possible on a 2K part.
+//
+//     uint8_t indexes[NUM_LEDS];
+//     CRGB colors[4];
+//     CIndexedPixelSource source(indexes, colors);
+//     AVRStreamClocklessController<5, C_NS(250), C_NS(625), C_NS(375), CIndexedPixelSource, GRB> output(source);
+//     FastLED.addLeds(&output, NULL, NUM_LEDS);
+//
+// The line is low while the next led is fetched and scaled and while each byte is spread into port values, which
+// stretches the low phase of the last bit of a byte.  Every gap has to stay below FASTLED_MAX_LOW_GAP_US (5us, see
+// clockless_trinket.h) or clone leds may latch in the middle of the frame.  The fetch is the part that depends on the
+// source; the StreamedPixels example measures the gaps on the real board.  Dithering is not applied.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <uint8_t DATA_PIN, int T1, int T2, int T3, class SOURCE, EOrder RGB_ORDER = GRB, int WAIT_TIME = 50>
+class AVRStreamClocklessController : public CLEDController {
+	static_assert(T1 >= 2 && T2 >= 2 && T3 >= 3, "Not enough cycles - use a higher clock speed");
+
+	typedef typename FastPin<DATA_PIN>::port_ptr_t data_ptr_t;
+
+	SOURCE & mSource;
+	CMinWait<WAIT_TIME> mWait;
+
+// 1 cycle, write a value to the pin's port
+#define STREAM_OUT1(V) if((int)(FastPin<DATA_PIN>::port())-0x20 < 64) { asm __volatile__("out %[PORT], %[v]" : : [PORT] "M" (FastPin<DATA_PIN>::port() - 0x20), [v] "r" (V)); } else { *FastPin<DATA_PIN>::port() = V; }
+
+// One bit, V is hi for a one and lo for a zero
+#define STREAM_BIT(V) STREAM_OUT1(hi) _dc<T1 - AVR_PIN_CYCLES(DATA_PIN)>(loopvar); STREAM_OUT1(V) _dc<T2 - AVR_PIN_CYCLES(DATA_PIN)>(loopvar); STREAM_OUT1(lo) _dc<T3 - AVR_PIN_CYCLES(DATA_PIN)>(loopvar);
+
+	// Port values for the 8 bits of a byte, MSB first, then the bits themselves
+	__attribute__((always_inline)) inline static void writeByte(uint8_t b, uint8_t hi, uint8_t lo, uint8_t & loopvar) {
+		uint8_t v0 = (b & 0x80) ? hi : lo;
+		uint8_t v1 = (b & 0x40) ? hi : lo;
+		uint8_t v2 = (b & 0x20) ? hi : lo;
+		uint8_t v3 = (b & 0x10) ? hi : lo;
+		uint8_t v4 = (b & 0x08) ? hi : lo;
+		uint8_t v5 = (b & 0x04) ? hi : lo;
+		uint8_t v6 = (b & 0x02) ? hi : lo;
+		uint8_t v7 = (b & 0x01) ? hi : lo;
+		STREAM_BIT(v0) STREAM_BIT(v1) STREAM_BIT(v2) STREAM_BIT(v3)
+		STREAM_BIT(v4) STREAM_BIT(v5) STREAM_BIT(v6) STREAM_BIT(v7)
+	}
+
+#undef STREAM_BIT
+#undef STREAM_OUT1
+
+	// Sends nLeds from the source, or nLeds times *color when color is set
+	void showInternal(const CRGB *color, int nLeds, const CRGB & scale) {
+		data_ptr_t port = FastPin<DATA_PIN>::port();
+		uint8_t hi = *port | FastPin<DATA_PIN>::mask();
+		uint8_t lo = *port & ~FastPin<DATA_PIN>::mask();
+		uint8_t loopvar = 0;
+		uint8_t s0 = scale.raw[RO(0)];
+		uint8_t s1 = scale.raw[RO(1)];
+		uint8_t s2 = scale.raw[RO(2)];
+		*port = lo;
+
+		mSource.begin();
+		while(nLeds-- > 0) {
+			CRGB pixel = color ? *color : mSource.next();
+			uint8_t b1 = scale8(pixel.raw[RO(1)], s1);
+			uint8_t b2 = scale8(pixel.raw[RO(2)], s2);
+			writeByte(scale8(pixel.raw[RO(0)], s0), hi, lo, loopvar);
+			writeByte(b1, hi, lo, loopvar);
+			writeByte(b2, hi, lo, loopvar);
+		}
+	}
+
+	void showTimed(const CRGB *color, int nLeds, const CRGB & scale) {
+		mWait.wait();
+		cli();
+
+		showInternal(color, nLeds, scale);
+
+		// Adjust the timer, the same way as the array based controller
+#if (!defined(NO_CORRECTION) || (NO_CORRECTION == 0)) && (FASTLED_ALLOW_INTERRUPTS == 0)
+		uint32_t microsTaken = (uint32_t)nLeds * (uint32_t)CLKS_TO_MICROS(24 * (T1 + T2 + T3));
+		// roughly 2us between bytes for fetching and spreading the bits
+		microsTaken += (uint32_t)nLeds * 3 * 2;
+		if(microsTaken > 1000) {
+			microsTaken -= 1000;
+			uint16_t x256ths = microsTaken >> 2;
+			x256ths += scale16by8(x256ths, 7);
+			x256ths += gTimeErrorAccum256ths;
+			MS_COUNTER += (x256ths >> 8);
+			gTimeErrorAccum256ths = x256ths & 0xFF;
+		}
+#endif
+
+		sei();
+		mWait.mark();
+	}
+
+protected:
+	virtual void showColor(const struct CRGB & data, int nLeds, CRGB scale) { showTimed(&data, nLeds, scale); }
+
+	// The array passed in is ignored, the leds come from the source
+	virtual void show(const struct CRGB * /* data */, int nLeds, CRGB scale) { showTimed(NULL, nLeds, scale); }
+
+public:
+	AVRStreamClocklessController(SOURCE & source) : mSource(source) {}
+
+	virtual void init() {
+		FastPin<DATA_PIN>::setOutput();
+		FastPin<DATA_PIN>::lo();
+	}
+
+	virtual uint16_t getMaxRefreshRate() const { return 400; }
+
+	/// The source whose leds are sent
+	SOURCE & source() { return mSource; }
+
+	/// There is no array to sum, the source is read in small chunks instead
+	virtual uint32_t getUnscaledPower_mW(bool & recomputed) {
+		recomputed = !m_bPowerCached || m_bPowerDirty;
+		if(recomputed) {
+			CRGB chunk[8];
+			uint32_t total = 0;
+			uint16_t count = size();
+			mSource.begin();
+			while(count) {
+				uint8_t n = (count > 8) ? 8 : count;
+				for(uint8_t i = 0; i < n; ++i) { chunk[i] = mSource.next(); }
+				total += calculate_unscaled_power_mW(chunk, n);
+				count -= n;
+			}
+			m_nPower_mW = total;
+			m_bPowerDirty = false;
+		}
+		return m_nPower_mW;
+	}
+};
+
+#endif
+
+FASTLED_NAMESPACE_END
+
+#endif
@@ -24,6 +24,10 @@ FASTLED_NAMESPACE_BEGIN
 
 #define US_PER_TICK (64 / (F_CPU/1000000))
 
+// Longest low phase inside a frame that no WS2812B takes as a reset.  The datasheets give 50us (280us for newer
+// parts), but some clones already latch after about 6us, so anything that stretches a low phase stays below this.
+#define FASTLED_MAX_LOW_GAP_US 5
+
 // Variations on the functions in delay.h - w/a loop var passed in to preserve registers across calls by the optimizer/compiler
 template<int CYCLES> inline void _dc(register uint8_t & loopvar);
 
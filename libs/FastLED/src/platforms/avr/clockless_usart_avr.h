@@ -0,0 +1,180 @@
+#ifndef __INC_CLOCKLESS_USART_AVR_H
+#define __INC_CLOCKLESS_USART_AVR_H
+
+#include "../../controller.h"
+#include "../../lib8tion.h"
+#include <avr/interrupt.h>
+
+FASTLED_NAMESPACE_BEGIN
+
+#if defined(FASTLED_AVR) && defined(UBRR0) && (F_CPU == 16000000)
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// WS2812 output through USART0 in master SPI mode.  Every WS2812 bit is sent as 4 SPI bits at F_CPU/6 (2.67MHz, 375ns):
+// 1000 for a zero (375ns high) and 1100 for a one (750ns high), so one SPI byte carries two led bits and every byte ends
+// with the line low.  The bytes are fed from the data register empty interrupt, interrupts stay enabled between bytes
+// and show() returns as soon as the first byte is queued.  A late refill only stretches a low phase, which the leds
+// tolerate up to FASTLED_MAX_LOW_GAP_US (see clockless_trinket.h), underruns() counts the refills that came late.
+//
+// The interrupt sends from one half of a two pixel buffer while the other half holds the next encoded pixel.  Every 12
+// bytes it switches halves and encodes the next pixel with interrupts enabled, the only time interrupts are blocked
+// is the few cycles it takes to queue a byte.  Only one controller can own USART0.  Data goes out on TXD (pin 1 on the uno),
+// XCK (pin 4) toggles the SPI clock and can't be used for anything else, and Serial is unavailable while it is in use.
+//
+// The sketch has to route the interrupt to the controller:
+//     ISR(USART_UDRE_vect) { ClocklessUSARTController<GRB, NUM_LEDS>::onDataRegisterEmpty(); }
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define USART_WS2812_TXD_PIN 1
+#define USART_WS2812_XCK_PIN 4
+
+template <EOrder RGB_ORDER = GRB, int MAX_LEDS = 64, int WAIT_TIME = 50>
+class ClocklessUSARTController : public CPixelLEDController<RGB_ORDER> {
+	// Two led bits per SPI byte, indexed by the bit pair
+	static const uint8_t BIT_PAIRS[4];
+
+	static const uint8_t PIXEL_BYTES = 12;
+
+	// Scaled pixels in wire order, filled by showPixels
+	static uint8_t sFrame[MAX_LEDS * 3];
+	static const uint8_t * volatile sNext;
+	static const uint8_t * volatile sEnd;
+
+	// Encoded pixels, the interrupt sends one half while the other waits
+	static uint8_t sBuffer[2][PIXEL_BYTES];
+	static volatile uint8_t sHalf;
+	static volatile uint8_t sPos;
+	static volatile uint16_t sRemaining; // pixels not completely sent
+	static volatile bool sBusy;
+	static volatile uint16_t sUnderruns;
+
+	// The wait is marked when the last byte goes into UDR0, it and the byte in the shift register still take 3us each
+	static const uint8_t TAIL_MICROS = 6;
+	static CMinWait<WAIT_TIME + TAIL_MICROS> sWait;
+
+	static void encodePixel(uint8_t *out, const uint8_t *pixel) {
+		for(uint8_t i = 0; i < 3; ++i) {
+			uint8_t b = pixel[i];
+			*out++ = BIT_PAIRS[b >> 6];
+			*out++ = BIT_PAIRS[(b >> 4) & 0x03];
+			*out++ = BIT_PAIRS[(b >> 2) & 0x03];
+			*out++ = BIT_PAIRS[b & 0x03];
+		}
+	}
+
+public:
+	virtual void init() {
+		FastPin<USART_WS2812_TXD_PIN>::setOutput();
+		FastPin<USART_WS2812_TXD_PIN>::lo();
+		FastPin<USART_WS2812_XCK_PIN>::setOutput();
+		UBRR0 = 0;
+		// Master SPI mode 0, MSB first
+		UCSR0C = (1<<UMSEL01)|(1<<UMSEL00);
+		UCSR0B = 0;
+		// must be set last, 2.67MHz
+		UBRR0 = 2;
+	}
+
+	virtual uint16_t getMaxRefreshRate() const { return 400; }
+
+	/// true while a frame is being sent
+	static bool busy() { return sBusy; }
+
+	/// number of times the data register ran empty in the middle of a frame
+	static uint16_t underruns() { uint16_t count; cli(); count = sUnderruns; sei(); return count; }
+
+	/// Call from ISR(USART_UDRE_vect)
+	static void onDataRegisterEmpty() __attribute__((always_inline)) {
+		// Transmit complete with data left means the shift register ran dry
+		if(UCSR0A & (1<<TXC0)) { ++sUnderruns; }
+
+		uint8_t half = sHalf;
+		uint8_t pos = sPos;
+		UDR0 = sBuffer[half][pos];
+		UCSR0A = (1<<TXC0);
+		if(++pos < PIXEL_BYTES) { sPos = pos; return; }
+
+		// This half is sent, switch to the pixel waiting in the other half and encode the next one into this half
+		sPos = 0;
+		if(--sRemaining == 0) {
+			UCSR0B &= ~(1<<UDRIE0);
+			sBusy = false;
+			sWait.mark();
+			return;
+		}
+		sHalf = half ^ 1;
+		const uint8_t *next = sNext;
+		if(next != sEnd) {
+			sNext = next + 3;
+			// The other half lasts 36us, let its bytes and other interrupts in while encoding
+			sei();
+			encodePixel(sBuffer[half], next);
+		}
+	}
+
+protected:
+	virtual void showPixels(PixelController<RGB_ORDER> & pixels) {
+		// The frame is still being read by the interrupt
+		while(sBusy);
+
+		uint8_t *out = sFrame;
+		int nLeds = pixels.size();
+		if(nLeds > MAX_LEDS) { nLeds = MAX_LEDS; }
+		if(nLeds == 0) { return; }
+		for(int i = 0; i < nLeds; ++i) {
+			*out++ = pixels.loadAndScale0();
+			*out++ = pixels.loadAndScale1();
+			*out++ = pixels.loadAndScale2();
+			pixels.advanceData();
+			pixels.stepDithering();
+		}
+
+		// Wait for the last byte of the previous frame to shift out and the leds to latch, WAIT_TIME after the line went low
+		sWait.wait();
+		while((UCSR0B & (1<<TXEN0)) && !(UCSR0A & (1<<TXC0)));
+
+		uint8_t encoded = (nLeds > 1) ? 2 : 1;
+		encodePixel(sBuffer[0], sFrame);
+		if(encoded > 1) { encodePixel(sBuffer[1], sFrame + 3); }
+		sNext = sFrame + encoded * 3;
+		sEnd = sFrame + nLeds * 3;
+		sRemaining = nLeds;
+		sHalf = 0;
+		sPos = 0;
+		sBusy = true;
+
+		UCSR0A = (1<<TXC0);
+		UCSR0B = (1<<TXEN0)|(1<<UDRIE0);
+	}
+};
+
+template <EOrder RGB_ORDER, int MAX_LEDS, int WAIT_TIME>
+const uint8_t ClocklessUSARTController<RGB_ORDER, MAX_LEDS, WAIT_TIME>::BIT_PAIRS[4] = { 0x88, 0x8C, 0xC8, 0xCC };
+template <EOrder RGB_ORDER, int MAX_LEDS, int WAIT_TIME>
+uint8_t ClocklessUSARTController<RGB_ORDER, MAX_LEDS, WAIT_TIME>::sFrame[MAX_LEDS * 3];
+template <EOrder RGB_ORDER, int MAX_LEDS, int WAIT_TIME>
+const uint8_t * volatile ClocklessUSARTController<RGB_ORDER, MAX_LEDS, WAIT_TIME>::sNext;
+template <EOrder RGB_ORDER, int MAX_LEDS, int WAIT_TIME>
+const uint8_t * volatile ClocklessUSARTController<RGB_ORDER, MAX_LEDS, WAIT_TIME>::sEnd;
+template <EOrder RGB_ORDER, int MAX_LEDS, int WAIT_TIME>
+uint8_t ClocklessUSARTController<RGB_ORDER, MAX_LEDS, WAIT_TIME>::sBuffer[2][PIXEL_BYTES];
+template <EOrder RGB_ORDER, int MAX_LEDS, int WAIT_TIME>
+volatile uint8_t ClocklessUSARTController<RGB_ORDER, MAX_LEDS, WAIT_TIME>::sHalf;
+template <EOrder RGB_ORDER, int MAX_LEDS, int WAIT_TIME>
+volatile uint8_t ClocklessUSARTController<RGB_ORDER, MAX_LEDS, WAIT_TIME>::sPos;
+template <EOrder RGB_ORDER, int MAX_LEDS, int WAIT_TIME>
+volatile uint16_t ClocklessUSARTController<RGB_ORDER, MAX_LEDS, WAIT_TIME>::sRemaining;
+template <EOrder RGB_ORDER, int MAX_LEDS, int WAIT_TIME>
+volatile bool ClocklessUSARTController<RGB_ORDER, MAX_LEDS, WAIT_TIME>::sBusy;
+template <EOrder RGB_ORDER, int MAX_LEDS, int WAIT_TIME>
+volatile uint16_t ClocklessUSARTController<RGB_ORDER, MAX_LEDS, WAIT_TIME>::sUnderruns;
+template <EOrder RGB_ORDER, int MAX_LEDS, int WAIT_TIME>
+CMinWait<WAIT_TIME + ClocklessUSARTController<RGB_ORDER, MAX_LEDS, WAIT_TIME>::TAIL_MICROS> ClocklessUSARTController<RGB_ORDER, MAX_LEDS, WAIT_TIME>::sWait;
+
+#endif
+
+FASTLED_NAMESPACE_END
+
+#endif
@@ -4,6 +4,9 @@
 #include "fastpin_avr.h"
 #include "fastspi_avr.h"
 #include "clockless_trinket.h"
+#include "clockless_usart_avr.h"
+#include "clockless_block_avr.h"
+#include "clockless_stream_avr.h"
 
 // Default to using PROGMEM
 #ifndef FASTLED_USE_PROGMEM
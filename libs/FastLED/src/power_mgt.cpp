@@ -47,6 +47,12 @@ static const uint8_t gMCU_mW  =  25 * 5; // 25mA @ 5v = 125 mW
 static uint8_t  gMaxPowerIndicatorLEDPinNumber = 0; // default = Arduino onboard LED pin.  set to zero to skip this.
 
 
+// The brightness returned by the last call, handed out again while no controller changed
+static uint8_t  gLastTargetBrightness = 0;
+static uint32_t gLastMaxPower_mW = 0;
+static uint8_t  gLastRecommendedBrightness = 0;
+
+
 uint32_t calculate_unscaled_power_mW( const CRGB* ledbuffer, uint16_t numLeds ) //25354
 {
     uint32_t red32 = 0, green32 = 0, blue32 = 0;
@@ -55,12 +61,48 @@ uint32_t calculate_unscaled_power_mW( const CRGB* ledbuffer, uint16_t numLeds )
 
     uint16_t count = numLeds;
 
-    // This loop might benefit from an AVR assembly version -MEK
+#if !defined(__AVR__) && defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    // Four leds are three words: R0 G0 B0 R1 | G1 B1 R2 G2 | B2 R3 G3 B3.  The even and odd bytes of every word
+    // are summed in two 16 bit lanes at once, at most 256 groups before the lanes are added up so they can't overflow.
+    while( count >= 4) {
+        uint16_t groups = count / 4;
+        if( groups > 256) { groups = 256; }
+        count -= groups * 4;
+
+        uint32_t even0 = 0, odd0 = 0, even1 = 0, odd1 = 0, even2 = 0, odd2 = 0;
+        while( groups) {
+            uint32_t w0, w1, w2;
+            memcpy( &w0, p, 4);
+            memcpy( &w1, p + 4, 4);
+            memcpy( &w2, p + 8, 4);
+            p += 12;
+            even0 += w0 & 0x00FF00FF;  odd0 += (w0 >> 8) & 0x00FF00FF;
+            even1 += w1 & 0x00FF00FF;  odd1 += (w1 >> 8) & 0x00FF00FF;
+            even2 += w2 & 0x00FF00FF;  odd2 += (w2 >> 8) & 0x00FF00FF;
+            --groups;
+        }
+
+        red32   += (even0 & 0xFFFF) + (odd0 >> 16) + (even1 >> 16) + (odd2 & 0xFFFF);
+        green32 += (odd0 & 0xFFFF) + (even1 & 0xFFFF) + (odd1 >> 16) + (even2 >> 16);
+        blue32  += (even0 >> 16) + (odd1 & 0xFFFF) + (even2 & 0xFFFF) + (odd2 >> 16);
+    }
+#endif
+
+    // 16 bit sums over runs of up to 255 leds, the 32 bit adds are only done once per run
     while( count) {
-        red32   += *p++;
-        green32 += *p++;
-        blue32  += *p++;
-        --count;
+        uint8_t run = (count > 255) ? 255 : count;
+        count -= run;
+
+        uint16_t red16 = 0, green16 = 0, blue16 = 0;
+        while( run) {
+            red16   += *p++;
+            green16 += *p++;
+            blue16  += *p++;
+            --run;
+        }
+        red32   += red16;
+        green32 += green16;
+        blue32  += blue16;
     }
 
     red32   *= gRed_mW;
@@ -76,6 +118,16 @@ uint32_t calculate_unscaled_power_mW( const CRGB* ledbuffer, uint16_t numLeds )
     return total;
 }
 
+uint32_t CLEDController::getUnscaledPower_mW( bool & recomputed)
+{
+    recomputed = !m_bPowerCached || m_bPowerDirty;
+    if( recomputed) {
+        m_nPower_mW = calculate_unscaled_power_mW( leds(), size());
+        m_bPowerDirty = false;
+    }
+    return m_nPower_mW;
+}
+
 
 uint8_t calculate_max_brightness_for_power_vmA(const CRGB* ledbuffer, uint16_t numLeds, uint8_t target_brightness, uint32_t max_power_V, uint32_t max_power_mA) {
 	return calculate_max_brightness_for_power_mW(ledbuffer, numLeds, target_brightness, max_power_V * max_power_mA);
@@ -100,13 +152,23 @@ uint8_t calculate_max_brightness_for_power_mW(const CRGB* ledbuffer, uint16_t nu
 uint8_t calculate_max_brightness_for_power_mW( uint8_t target_brightness, uint32_t max_power_mW)
 {
     uint32_t total_mW = gMCU_mW;
+    bool changed = false;
 
     CLEDController *pCur = CLEDController::head();
 	while(pCur) {
-        total_mW += calculate_unscaled_power_mW( pCur->leds(), pCur->size());
+        bool recomputed;
+        total_mW += pCur->getUnscaledPower_mW( recomputed);
+        changed |= recomputed;
 		pCur = pCur->next();
 	}
 
+    // Nothing changed since the last frame, neither will the answer
+    if( !changed && target_brightness == gLastTargetBrightness && max_power_mW == gLastMaxPower_mW) {
+        return gLastRecommendedBrightness;
+    }
+    gLastTargetBrightness = target_brightness;
+    gLastMaxPower_mW = max_power_mW;
+
 #if POWER_DEBUG_PRINT == 1
     Serial.print("power demand at full brightness mW = ");
     Serial.println( total_mW);
@@ -131,6 +193,7 @@ uint8_t calculate_max_brightness_for_power_mW( uint8_t target_brightness, uint32
 #if POWER_DEBUG_PRINT == 1
         Serial.print("demand is under the limit");
 #endif
+        gLastRecommendedBrightness = target_brightness;
         return target_brightness;
     }
 
@@ -152,6 +215,7 @@ uint8_t calculate_max_brightness_for_power_mW( uint8_t target_brightness, uint32
     }
 #endif
 
+    gLastRecommendedBrightness = recommended_brightness;
     return recommended_brightness;
 }
 
@@ -0,0 +1,54 @@
+// Characters per second of write() with fixed and proportional fonts.
+// The characters go to a display that discards them, so only the glyph
+// lookup and the column loop are timed, no display is needed.
+// Set GLYPH_INDEX_DIM in SSD1306Ascii.h to zero to compare without the
+// glyph index.
+
+#include "SSD1306Ascii.h"
+
+// Discards all writes.
+class NullDisplay : public SSD1306Ascii {
+ public:
+  NullDisplay() {
+    m_displayWidth = 128;
+    m_displayHeight = 64;
+  }
+
+ protected:
+  void writeDisplay(uint8_t b, uint8_t mode) {
+    (void)b;
+    (void)mode;
+  }
+};
+
+NullDisplay display;
+
+// Write 1000 characters, from the first to the last of the font.
+void bench(const __FlashStringHelper* name, const uint8_t* font) {
+  display.setFont(font);
+  uint8_t first = display.fontFirstChar();
+  uint8_t count = display.fontCharCount();
+  uint32_t start = micros();
+  for (uint16_t i = 0; i < 1000; i++) {
+    display.setCol(0);
+    display.write((uint8_t)(first + i%count));
+  }
+  uint32_t us = micros() - start;
+  Serial.print(name);
+  Serial.print(F(": "));
+  Serial.print(1000000000UL/us);
+  Serial.println(F(" chars/sec"));
+}
+//------------------------------------------------------------------------------
+void setup() {
+  Serial.begin(9600);
+  while (!Serial) {}
+  Serial.print(F("GLYPH_INDEX_DIM: "));
+  Serial.println(GLYPH_INDEX_DIM);
+  bench(F("System5x7 (fixed)"), System5x7);
+  bench(F("Arial14"), Arial14);
+  bench(F("Verdana12"), Verdana12);
+  bench(F("Callibri15"), Callibri15);
+}
+//------------------------------------------------------------------------------
+void loop() {}
@@ -52,6 +52,9 @@ void setup() {
 
   // Try this for full screen width with set1X.
   // oled.tickerInit(&state, Adafruit5x7, 2);
+
+  // Try this to let the SSD1306 shift the field, a tick only sends one column.
+  // oled.tickerInit(&state, Adafruit5x7, 2, false, 16, 100, true);
 }
 uint32_t tickTime = 0;
 int n = 0;
@@ -19,18 +19,45 @@
  */
 #include "SSD1306Ascii.h"
 //------------------------------------------------------------------------------
+// Reads the bytes of a run length encoded glyph, see FONT_TYPE_RLE.
+struct RleReader {
+  const uint8_t* next;
+  uint8_t left;  // Bytes left in the current run.
+  bool repeat;
+  uint8_t value;
+
+  uint8_t read() {
+    if (!left) {
+      uint8_t control = readFontByte(next++);
+      repeat = control & 0X80;
+      if (repeat) {
+        left = (control & 0X7F) + 2;
+        value = readFontByte(next++);
+      } else {
+        left = control + 1;
+      }
+    }
+    left--;
+    return repeat ? value : readFontByte(next++);
+  }
+};
+//------------------------------------------------------------------------------
 uint8_t SSD1306Ascii::charWidth(uint8_t c) const {
   if (!m_font) {
     return 0;
   }
-  uint8_t first = readFontByte(m_font + FONT_FIRST_CHAR);
-  uint8_t count = readFontByte(m_font + FONT_CHAR_COUNT);
-  if (c < first || c >= (first + count)) {
+  int16_t i = glyphIndex(c);
+  if (i < 0) {
     return 0;
   }
-  if (fontSize() > 1) {
+  uint16_t type = fontSize();
+  if (type == FONT_TYPE_RLE) {
+    // Widths follow the character table.
+    i += readFontByte(m_font + FONT_CHAR_COUNT);
+  }
+  if (type > 1) {
     // Proportional font.
-    return m_magFactor*readFontByte(m_font + FONT_WIDTH_TABLE + c - first);
+    return m_magFactor*readFontByte(m_font + FONT_WIDTH_TABLE + i);
   }
   // Fixed width font.
   return m_magFactor*readFontByte(m_font + FONT_WIDTH);
@@ -98,6 +125,89 @@ uint16_t SSD1306Ascii::fontSize() const {
   return (readFontByte(m_font) << 8) | readFontByte(m_font + 1);
 }
 //------------------------------------------------------------------------------
+int16_t SSD1306Ascii::glyphIndex(uint8_t ch) const {
+  uint8_t first = readFontByte(m_font + FONT_FIRST_CHAR);
+  uint8_t count = readFontByte(m_font + FONT_CHAR_COUNT);
+  if (fontSize() != FONT_TYPE_RLE) {
+    return ch < first || ch >= (first + count) ? -1 : ch - first;
+  }
+  // Binary search of the sorted character table.
+  const uint8_t* chars = m_font + FONT_CHAR_TABLE;
+  uint8_t lo = 0;
+  uint8_t hi = count;
+  while (lo < hi) {
+    uint8_t mid = lo + (hi - lo)/2;
+    uint8_t c = readFontByte(chars + mid);
+    if (c == ch) {
+      return mid;
+    }
+    if (c < ch) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return -1;
+}
+//------------------------------------------------------------------------------
+uint16_t SSD1306Ascii::glyphOffset(uint8_t ch) {
+  const uint8_t* widths = m_font + FONT_WIDTH_TABLE;
+  uint16_t index = 0;
+  uint8_t i = 0;
+#if GLYPH_INDEX_DIM
+  if (!m_glyphStep) {
+    uint8_t count = readFontByte(m_font + FONT_CHAR_COUNT);
+    m_glyphStep = count > GLYPH_INDEX_DIM ?
+                  (count + GLYPH_INDEX_DIM - 1)/GLYPH_INDEX_DIM : 1;
+    for (uint8_t n = 0; n < GLYPH_INDEX_DIM && i < count; n++) {
+      m_glyphIndex[n] = index;
+      for (uint8_t k = 0; k < m_glyphStep && i < count; k++) {
+        index += readFontByte(widths + i++);
+      }
+    }
+  }
+  i = ch - ch%m_glyphStep;
+  index = m_glyphIndex[ch/m_glyphStep];
+#endif  // GLYPH_INDEX_DIM
+  for (; i < ch; i++) {
+    index += readFontByte(widths + i);
+  }
+  return index;
+}
+//------------------------------------------------------------------------------
+uint8_t SSD1306Ascii::glyphByte(uint8_t ch, uint8_t r, uint8_t c) {
+  uint8_t w = readFontByte(m_font + FONT_WIDTH);
+  uint8_t h = readFontByte(m_font + FONT_HEIGHT);
+  uint8_t nr = (h + 7)/8;
+  uint8_t count = readFontByte(m_font + FONT_CHAR_COUNT);
+  const uint8_t* base = m_font + FONT_WIDTH_TABLE;
+  uint16_t type = fontSize();
+  ch = glyphIndex(ch);
+  if (type < 2) {
+    // Fixed width font.
+    return readFontByte(base + nr*w*ch + r*w + c);
+  }
+  uint8_t b;
+  if (type == FONT_TYPE_RLE) {
+    w = readFontByte(base + count + ch);
+    const uint8_t* offset = base + 2*count + 2*ch;
+    RleReader rle = {base + 4*count +
+                     (readFontByte(offset) << 8 | readFontByte(offset + 1)),
+                     0, false, 0};
+    for (uint16_t i = r*w + c; i > 0; i--) {
+      rle.read();
+    }
+    b = rle.read();
+  } else {
+    w = readFontByte(base + ch);
+    b = readFontByte(base + count + nr*glyphOffset(ch) + r*w + c);
+  }
+  if ((h & 7) && (r + 1) == nr) {
+    b >>= 8 - (h & 7);
+  }
+  return b;
+}
+//------------------------------------------------------------------------------
 uint8_t SSD1306Ascii::fontWidth() const {
   return m_font ? m_magFactor*readFontByte(m_font + FONT_WIDTH) : 0;
 }
@@ -144,6 +254,11 @@ void SSD1306Ascii::setCursor(uint8_t col, uint8_t row) {
 }
 //------------------------------------------------------------------------------
 void SSD1306Ascii::setFont(const uint8_t* font) {
+#if GLYPH_INDEX_DIM
+  if (font != m_font) {
+    m_glyphStep = 0;
+  }
+#endif  // GLYPH_INDEX_DIM
   m_font = font;
   if (font && fontSize() == 1) {
      m_letterSpacing = 0;
@@ -211,13 +326,15 @@ size_t SSD1306Ascii::strWidth(const char* str) const {
 }
 //------------------------------------------------------------------------------
 void SSD1306Ascii::tickerInit(TickerState* state, const uint8_t* font,
-       uint8_t row, bool mag2X, uint8_t bgnCol, uint8_t endCol) {
+       uint8_t row, bool mag2X, uint8_t bgnCol, uint8_t endCol,
+       bool hwScroll) {
   state->font = font;
   state->row = row;
   state->mag2X = mag2X;
   state->bgnCol = bgnCol;
   state->endCol = endCol < m_displayWidth ? endCol : m_displayWidth - 1;
   state->nQueue = 0;
+  state->hwScroll = hwScroll;
 }
 //------------------------------------------------------------------------------
 bool SSD1306Ascii::tickerText(TickerState* state, const char* text) {
@@ -235,6 +352,76 @@ bool SSD1306Ascii::tickerText(TickerState* state, const char* text) {
   return true;
 }
 //------------------------------------------------------------------------------
+int8_t SSD1306Ascii::tickerScroll(TickerState* state) {
+  // Sent strings are dropped, the last one stays until it is shifted out.
+  while (state->nQueue > 1 && !*state->queue[0]) {
+    state->nQueue--;
+    for (uint8_t i = 0; i < state->nQueue; i++) {
+      state->queue[i] = state->queue[i + 1];
+    }
+  }
+  uint8_t ch = *state->queue[0];
+  if (ch) {
+    state->col = state->endCol - state->bgnCol + 1;
+  } else if (state->col) {
+    state->col--;
+  } else {
+    state->nQueue = 0;
+    return 0;
+  }
+  // Shift the field, one command per run of RAM pages, and move to the
+  // column at endCol in one transmission.  Rows below the display are
+  // left out like write() does.
+  uint8_t rows = fontRows();
+  if (state->row + rows > displayRows()) {
+    rows = displayRows() - state->row;
+  }
+  uint8_t cmds[19];
+  uint8_t n = 0;
+  uint8_t col = state->endCol + m_colOffset;
+  for (uint8_t r = 0; r < rows;) {
+    uint8_t page = ramPage(state->row + r);
+    uint8_t last = page + rows - r - 1;
+    if (last > 7) {
+      last = 7;
+    }
+    cmds[n++] = SSD1306_CONTENT_SCROLL_LEFT;
+    cmds[n++] = 0X00;
+    cmds[n++] = page;
+    cmds[n++] = 0X01;
+    cmds[n++] = last;
+    cmds[n++] = 0X00;
+    cmds[n++] = state->bgnCol + m_colOffset;
+    cmds[n++] = col;
+    r += last - page + 1;
+  }
+  uint8_t width = charWidth(ch)/m_magFactor;
+  uint8_t c = state->skip/m_magFactor;
+  for (uint8_t r = 0; r < rows; r++) {
+    cmds[n++] = SSD1306_SETLOWCOLUMN | (col & 0XF);
+    cmds[n++] = SSD1306_SETHIGHCOLUMN | (col >> 4);
+    cmds[n++] = SSD1306_SETSTARTPAGE | ramPage(state->row + r);
+    ssd1306WriteCmds(cmds, n);
+    n = 0;
+    m_col = state->endCol;
+    m_row = state->row + r;
+    uint8_t b = 0;
+    if (c < width) {
+      b = glyphByte(ch, r/m_magFactor, c);
+      if (m_magFactor == 2) {
+        b = r & 1 ? b >> 4 : b & 0XF;
+        b = readFontByte(scaledNibble + b);
+      }
+    }
+    ssd1306WriteRam(b);
+  }
+  if (ch && ++state->skip >= charSpacing(ch)) {
+    state->skip = 0;
+    state->queue[0]++;
+  }
+  return state->nQueue;
+}
+//------------------------------------------------------------------------------
 int8_t SSD1306Ascii::tickerTick(TickerState* state) {
   if (!state->font) {
     return -1;
@@ -246,10 +433,13 @@ int8_t SSD1306Ascii::tickerTick(TickerState* state) {
   m_magFactor = state->mag2X ? 2 : 1;
   if (state->init) {
     clear(state->bgnCol, state->endCol, state->row, state->row + fontRows() -1);
-    state->col = state->endCol;
+    state->col = state->hwScroll ? 0 : state->endCol;
     state->skip = 0;
     state->init = false;
   }
+  if (state->hwScroll) {
+    return tickerScroll(state);
+  }
   // Adjust display width to truncate pixels after endCol.  Find better way?
   uint8_t save = m_displayWidth;
   m_displayWidth = state->endCol + 1;
@@ -301,11 +491,11 @@ size_t SSD1306Ascii::write(uint8_t ch) {
   uint8_t w = readFontByte(m_font + FONT_WIDTH);
   uint8_t h = readFontByte(m_font + FONT_HEIGHT);
   uint8_t nr = (h + 7)/8;
-  uint8_t first = readFontByte(m_font + FONT_FIRST_CHAR);
   uint8_t count = readFontByte(m_font + FONT_CHAR_COUNT);
   const uint8_t* base = m_font + FONT_WIDTH_TABLE;
+  int16_t index = glyphIndex(ch);
 
-  if (ch < first || ch >= (first + count)) {
+  if (index < 0) {
     if (ch == '\r') {
       setCol(0);
       return 1;
@@ -335,34 +525,42 @@ size_t SSD1306Ascii::write(uint8_t ch) {
     }
     return 0;
   }
-  ch -= first;
+  ch = index;
   uint8_t s = letterSpacing();
   uint8_t thieleShift = 0;
-  if (fontSize() < 2) {
+  uint16_t type = fontSize();
+  RleReader rle = {nullptr, 0, false, 0};
+  if (type < 2) {
     // Fixed width font.
     base += nr*w*ch;
   } else {
     if (h & 7) {
       thieleShift = 8 - (h & 7);
     }
-    uint16_t index = 0;
-    for (uint8_t i = 0; i < ch; i++) {
-      index += readFontByte(base + i);
+    if (type == FONT_TYPE_RLE) {
+      w = readFontByte(base + count + ch);
+      const uint8_t* offset = base + 2*count + 2*ch;
+      rle.next = base + 4*count +
+                 (readFontByte(offset) << 8 | readFontByte(offset + 1));
+    } else {
+      w = readFontByte(base + ch);
+      base += nr*glyphOffset(ch) + count;
     }
-    w = readFontByte(base + ch);
-    base += nr*index + count;
   }
   uint8_t scol = m_col;
   uint8_t srow = m_row;
   uint8_t skip = m_skip;
   for (uint8_t r = 0; r < nr; r++) {
+    // Magnified rows are decoded again for the second half.
+    RleReader rowStart = rle;
     for (uint8_t m = 0; m < m_magFactor; m++) {
       skipColumns(skip);
       if (r || m) {
         setCursor(scol, m_row + 1);
+        rle = rowStart;
       }
       for (uint8_t c = 0; c < w; c++) {
-        uint8_t b = readFontByte(base + c + r*w);
+        uint8_t b = rle.next ? rle.read() : readFontByte(base + c + r*w);
         if (thieleShift && (r + 1) == nr) {
           b >>= thieleShift;
         }
@@ -48,9 +48,28 @@
 /** Dimension of TickerState pointer queue */
 #define TICKER_QUEUE_DIM 6
 
+/** Entries of the RAM glyph offset index for proportional fonts.
+ *
+ * Finding a glyph in a proportional font takes the sum of the widths of
+ * all glyphs before it.  The index holds that sum for every n-th glyph of
+ * the current font, n the smallest step that fits the font in the index,
+ * so a glyph takes at most n - 1 width reads.  A font of up to
+ * GLYPH_INDEX_DIM glyphs is indexed glyph by glyph.  The index costs two
+ * bytes of RAM per entry and is built on the first write with a new font.
+ * Zero disables the index.
+ */
+#define GLYPH_INDEX_DIM 16
+
 /** Use larger faster I2C code. */
 #define OPTIMIZE_I2C 1
 
+/** If nonzero, SSD1306AsciiWire queues display writes in a RAM ring of
+    this many bytes, at most 255, and sends them in time limited slices
+    with sendQueued().  Define it before including SSD1306AsciiWire.h. */
+#ifndef WIRE_QUEUE_SIZE
+#define WIRE_QUEUE_SIZE 0
+#endif  // WIRE_QUEUE_SIZE
+
 /** If MULTIPLE_I2C_PORTS is nonzero,
     define a constructor with port selection. */
 #ifdef __AVR__
@@ -107,6 +126,11 @@ struct TickerState {
   bool init;       ///< clear and initialize display area if true.
   uint8_t col;     ///< Column for start of displayed text.
   uint8_t skip;    ///< Number of pixels to skip in first character.
+  /** Shift with the controller's content scroll, see tickerInit().
+      The text is then fed in at endCol, skip counts the pixels of the
+      first character that were sent and col the columns still to shift
+      after the end of the text. */
+  bool hwScroll;
   /// @return Count of free queue slots.
   uint8_t queueFree() {return TICKER_QUEUE_DIM - nQueue;}
   /// @return Count of used queue slots.
@@ -381,6 +405,17 @@ class SSD1306Ascii : public Print {
    * @note The byte will immediately be sent to the controller.
    */
   void ssd1306WriteCmd(uint8_t c) {writeDisplay(c, SSD1306_MODE_CMD);}
+  /**
+   * @brief Write command bytes to the display controller.
+   *
+   * @param[in] cmds The command bytes.
+   * @param[in] n Number of command bytes.
+   * @note The bytes will immediately be sent to the controller, in one
+   *       transmission if the interface supports it.
+   */
+  void ssd1306WriteCmds(const uint8_t* cmds, uint8_t n) {
+    writeDisplayCmds(cmds, n);
+  }
   /**
    * @brief Write a byte to RAM in the display controller.
    *
@@ -418,9 +453,17 @@ class SSD1306Ascii : public Print {
    * @param[in] mag2X set magFactor to two if true.
    * @param[in] bgnCol First column of ticker. Default is zero.
    * @param[in] endCol Last column of ticker. Default is last column of display.
+   * @param[in] hwScroll Shift the field with the SSD1306 content scroll
+   *            command and only send the new column at endCol on a tick,
+   *            instead of the whole field.  The SSD1306 needs at least two
+   *            frame periods between scroll commands, about 20 ms with the
+   *            default clock of the init tables, ticks that come faster
+   *            lose shifts.  The SH1106 and many SSD1306 clones ignore the
+   *            command.  Not after displayRemap(false).  Default is false.
    */
   void tickerInit(TickerState* state, const uint8_t* font, uint8_t row,
-       bool mag2X = false, uint8_t bgnCol = 0, uint8_t endCol = 255);
+       bool mag2X = false, uint8_t bgnCol = 0, uint8_t endCol = 255,
+       bool hwScroll = false);
   /**
    *  @brief Add text pointer to display queue.
    *
@@ -457,7 +500,24 @@ class SSD1306Ascii : public Print {
 
  protected:
   uint16_t fontSize() const;
+  // Index of ch in the glyph tables of the font, -1 if it has no glyph.
+  int16_t glyphIndex(uint8_t ch) const;
+  uint16_t glyphOffset(uint8_t ch);
+  uint8_t glyphByte(uint8_t ch, uint8_t r, uint8_t c);
+  int8_t tickerScroll(TickerState* state);
+  uint8_t ramPage(uint8_t row) const {
+#if INCLUDE_SCROLLING
+    return (row + m_pageOffset) & 7;
+#else  // INCLUDE_SCROLLING
+    return row;
+#endif  // INCLUDE_SCROLLING
+  }
   virtual void writeDisplay(uint8_t b, uint8_t mode) = 0;
+  virtual void writeDisplayCmds(const uint8_t* cmds, uint8_t n) {
+    for (uint8_t i = 0; i < n; i++) {
+      writeDisplay(cmds[i], SSD1306_MODE_CMD);
+    }
+  }
   uint8_t m_col;            // Cursor column.
   uint8_t m_row;            // Cursor RAM row.
   uint8_t m_displayWidth;   // Display width.
@@ -473,5 +533,9 @@ class SSD1306Ascii : public Print {
   const uint8_t* m_font = nullptr;  // Current font.
   uint8_t m_invertMask = 0;  // font invert mask
   uint8_t m_magFactor = 1;   // Magnification factor.
+#if GLYPH_INDEX_DIM
+  uint8_t m_glyphStep = 0;  // Glyphs per index entry, zero if not built.
+  uint16_t m_glyphIndex[GLYPH_INDEX_DIM];  // Offsets of every step glyph.
+#endif  // GLYPH_INDEX_DIM
 };
 #endif  // SSD1306Ascii_h
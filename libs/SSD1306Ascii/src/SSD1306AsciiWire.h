@@ -51,8 +51,19 @@ class SSD1306AsciiWire : public SSD1306Ascii {
 #if OPTIMIZE_I2C
     m_nData = 0;
 #endif  // OPTIMIZE_I2C
+#if WIRE_QUEUE_SIZE
+    m_queueHead = 0;
+    m_queueCount = 0;
+    m_queueOpen = QUEUE_CLOSED;
+    m_queueByteMicros = 25;
+#endif  // WIRE_QUEUE_SIZE
     m_i2cAddr = i2cAddr;
     init(dev);
+#if WIRE_QUEUE_SIZE
+    while (m_queueCount) {
+      sendChunk();
+    }
+#endif  // WIRE_QUEUE_SIZE
   }
   /**
    * @brief Initialize the display controller.
@@ -72,10 +83,75 @@ class SSD1306AsciiWire : public SSD1306Ascii {
   void set400kHz() __attribute__((deprecated("use Wire.setClock(400000L)"))) {
     m_oledWire.setClock(400000L);
   }
+#if WIRE_QUEUE_SIZE
+  /**
+   * @brief Send queued display writes for at most a time limit.
+   *
+   * Writes are sent in transmissions of up to 17 data bytes or one
+   * command.  A transmission is only started if it is expected to end
+   * within the limit, from the measured time of the previous ones, but
+   * at least one is sent per call.  At 400 kHz a full transmission
+   * takes about 500 us.
+   *
+   * @param[in] maxMicros Time limit in microseconds.
+   * @return true if the queue is empty.
+   */
+  bool sendQueued(uint16_t maxMicros) {
+    uint32_t start = micros();
+    bool first = true;
+    while (m_queueCount) {
+      uint16_t bytes = (m_queue[m_queueHead] & QUEUE_LENGTH_MASK) + 2;
+      if (!first && micros() - start + bytes*m_queueByteMicros > maxMicros) {
+        break;
+      }
+      sendChunk();
+      first = false;
+    }
+    return m_queueCount == 0;
+  }
+  /**
+   * @return The number of queued bytes, headers included.
+   */
+  uint8_t queuedBytes() const {return m_queueCount;}
+  /**
+   * @return The number of bytes that can be queued before a write has to
+   *         wait for the bus.  A transmission takes one header byte on top
+   *         of its data.
+   */
+  uint8_t queueFree() const {return WIRE_QUEUE_SIZE - m_queueCount;}
+#endif  // WIRE_QUEUE_SIZE
 
  protected:
   void writeDisplay(uint8_t b, uint8_t mode) {
-#if OPTIMIZE_I2C
+#if WIRE_QUEUE_SIZE
+    // Add to the open data transmission or start a new one.  A full
+    // queue is sent until there is room, callers that must not wait keep
+    // their writes within queueFree().
+    for (;;) {
+      uint8_t room = WIRE_QUEUE_SIZE - m_queueCount;
+      if (m_queueOpen != QUEUE_CLOSED && mode != SSD1306_MODE_CMD && room) {
+        m_queue[m_queueOpen]++;
+        break;
+      }
+      if (m_queueOpen == QUEUE_CLOSED && room >= 2) {
+        m_queueOpen = queueIndex(m_queueCount);
+        m_queue[m_queueOpen] = (mode == SSD1306_MODE_CMD ? 0 : QUEUE_DATA) | 1;
+        m_queueCount++;
+        break;
+      }
+      if (m_queueOpen != QUEUE_CLOSED && mode == SSD1306_MODE_CMD) {
+        m_queueOpen = QUEUE_CLOSED;
+      } else {
+        sendChunk();
+      }
+    }
+    m_queue[queueIndex(m_queueCount)] = b;
+    m_queueCount++;
+    if (mode != SSD1306_MODE_RAM_BUF ||
+        (m_queue[m_queueOpen] & QUEUE_LENGTH_MASK) == QUEUE_MAX_DATA) {
+      m_queueOpen = QUEUE_CLOSED;
+    }
+#elif OPTIMIZE_I2C
     if (m_nData > 16 || (m_nData && mode == SSD1306_MODE_CMD)) {
       m_oledWire.endTransmission();
       m_nData = 0;
@@ -98,14 +174,92 @@ class SSD1306AsciiWire : public SSD1306Ascii {
     m_oledWire.endTransmission();
 #endif    // OPTIMIZE_I2C
   }
+  // Commands go out in one transmission if they fit the Wire buffer, longer
+  // lists are split, the controller reads the bytes the same way.
+  void writeDisplayCmds(const uint8_t* cmds, uint8_t n) {
+    while (n > WIRE_MAX_CMDS) {
+      writeDisplayCmds(cmds, WIRE_MAX_CMDS);
+      cmds += WIRE_MAX_CMDS;
+      n -= WIRE_MAX_CMDS;
+    }
+#if WIRE_QUEUE_SIZE
+    m_queueOpen = QUEUE_CLOSED;
+    while (WIRE_QUEUE_SIZE - m_queueCount < n + 1) {
+      sendChunk();
+    }
+    m_queue[queueIndex(m_queueCount++)] = n;
+    for (uint8_t i = 0; i < n; i++) {
+      m_queue[queueIndex(m_queueCount++)] = cmds[i];
+    }
+#else  // WIRE_QUEUE_SIZE
+#if OPTIMIZE_I2C
+    if (m_nData) {
+      m_oledWire.endTransmission();
+      m_nData = 0;
+    }
+#endif  // OPTIMIZE_I2C
+    m_oledWire.beginTransmission(m_i2cAddr);
+    m_oledWire.write(0X00);
+    for (uint8_t i = 0; i < n; i++) {
+      m_oledWire.write(cmds[i]);
+    }
+    m_oledWire.endTransmission();
+#endif  // WIRE_QUEUE_SIZE
+  }
 
  protected:
 #if MULTIPLE_I2C_PORTS
   decltype(Wire)& m_oledWire;
 #endif  // MULTIPLE_I2C_PORTS
+  // Command bytes per transmission, the smallest Wire buffer is 32 bytes
+  // including the control byte, a small queue holds a header and fewer.
+  static const uint8_t WIRE_MAX_CMDS =
+    WIRE_QUEUE_SIZE && WIRE_QUEUE_SIZE <= 31 ? WIRE_QUEUE_SIZE - 1 : 31;
   uint8_t m_i2cAddr;
 #if OPTIMIZE_I2C
   uint8_t m_nData;
 #endif  // OPTIMIZE_I2C
+#if WIRE_QUEUE_SIZE
+  // Each transmission is a header, the data flag and the number of bytes,
+  // followed by the bytes.
+  static const uint8_t QUEUE_DATA = 0X80;
+  static const uint8_t QUEUE_LENGTH_MASK = 0X7F;
+  static const uint8_t QUEUE_MAX_DATA = 17;
+  static const uint8_t QUEUE_CLOSED = 0XFF;
+  static_assert(WIRE_QUEUE_SIZE >= 2 && WIRE_QUEUE_SIZE <= 255,
+                "WIRE_QUEUE_SIZE must be in the range 2 to 255");
+  static_assert(WIRE_MAX_CMDS <= QUEUE_LENGTH_MASK,
+                "a command transmission must fit the queue header");
+
+  uint8_t queueIndex(uint8_t offset) const {
+    uint16_t i = m_queueHead + offset;
+    return i < WIRE_QUEUE_SIZE ? i : i - WIRE_QUEUE_SIZE;
+  }
+  // Send the transmission at the head of the queue.
+  void sendChunk() {
+    uint32_t start = micros();
+    uint8_t header = m_queue[m_queueHead];
+    uint8_t n = header & QUEUE_LENGTH_MASK;
+    if (m_queueOpen == m_queueHead) {
+      m_queueOpen = QUEUE_CLOSED;
+    }
+    m_oledWire.beginTransmission(m_i2cAddr);
+    m_oledWire.write(header & QUEUE_DATA ? 0X40 : 0X00);
+    for (uint8_t i = 1; i <= n; i++) {
+      m_oledWire.write(m_queue[queueIndex(i)]);
+    }
+    m_oledWire.endTransmission();
+    m_queueHead = queueIndex(n + 1);
+    m_queueCount -= n + 1;
+    // Address and control byte come on top of the data.
+    m_queueByteMicros = (micros() - start)/(n + 2);
+  }
+
+  uint8_t m_queue[WIRE_QUEUE_SIZE];
+  uint8_t m_queueHead;
+  uint8_t m_queueCount;
+  uint8_t m_queueOpen;  // Header of the data transmission being filled.
+  uint16_t m_queueByteMicros;
+#endif  // WIRE_QUEUE_SIZE
 };
 #endif  // SSD1306AsciiWire_h
@@ -77,6 +77,9 @@
 #define SSD1306_SETPRECHARGE 0xD9
 /** Deactivate scroll */
 #define SSD1306_DEACTIVATE_SCROLL 0x2E
+/** Scroll the content of a column range one column left. Followed by
+    0X00, start page, 0X01, end page, 0X00, start column, end column. */
+#define SSD1306_CONTENT_SCROLL_LEFT 0x2D
 /** No Operation Command. */
 #define SSD1306_NOP 0XE3
 //------------------------------------------------------------------------------
@@ -32,6 +32,8 @@
  * 00 00 (fixed width font with 1 padding pixel on right and below)
  * 
  * 00 01 (fixed width font with no padding pixels)
+ *
+ * 00 02 (proportional font with run length encoded glyphs)
  */
 #define FONT_LENGTH      0
 /** Maximum character width. */
@@ -44,6 +46,20 @@
 #define FONT_CHAR_COUNT  5
 /** Offset to width table. */
 #define FONT_WIDTH_TABLE 6
+/** Offset to the character table of a run length encoded font. */
+#define FONT_CHAR_TABLE  6
+/** FONT_LENGTH of a proportional font with run length encoded glyphs.
+ *
+ * The characters need not be a range.  FONT_FIRST_CHAR is the lowest one
+ * and FONT_CHAR_COUNT the number of glyphs.  The header is followed by the
+ * character table, the codes of the glyphs in ascending order, then the
+ * width table and a 16 bit Big Endian offset for every glyph, from the end
+ * of the offset table to the encoded glyph.  The glyph is encoded as one
+ * stream of all its rows.  A control byte with the high bit set repeats
+ * the next byte (control & 0X7F) + 2 times, one without it is followed by
+ * control + 1 bytes that are copied.
+ */
+#define FONT_TYPE_RLE    2
 //
 // FONT_LENGTH is a 16 bit Big Endian length field.
 // Unfortunately, FontCreator2 screwed up the value it put in the field
@@ -51,6 +67,7 @@
 // some special things.
 // 00 00 (fixed width font with 1 padding pixel on right and below)
 // 00 01 (fixed width font with no padding pixels)
+// 00 02 (proportional font with run length encoded glyphs)
 // FONT_WIDTH it the max character width.
 // any other value means variable width font in FontCreator2 (thiele)
 // format with pixel padding
@@ -0,0 +1,126 @@
+#ifndef LOOP_WATCHDOG_CPP
+#define LOOP_WATCHDOG_CPP
+
+#include <Arduino.h>
+#ifdef __AVR__
+#include <avr/wdt.h>
+#include <avr/eeprom.h>
+#endif
+
+#define STALL_RECORD_ADDRESS 0 // EEPROM address of the stall record
+#define STALL_RECORD_MAGIC 0xA5
+
+// Parts of loop() the watchdog can blame
+enum LoopStage : uint8_t {
+  STAGE_NONE = 0,
+  STAGE_CAN_LISTEN,
+  STAGE_CAN_POLL,
+  STAGE_BEEPER,
+  STAGE_RIDE_STATE,
+  STAGE_RENDER,
+  STAGE_SHOW,
+  STAGE_DASHBOARD
+};
+
+struct StallRecord {
+  uint8_t magic;
+  uint8_t stage;
+  uint32_t canId;     // last CAN frame received before the stall
+  uint32_t timestamp; // millis() when the watchdog fired
+};
+
+// Resets the board when a loop pass takes longer than the hardware watchdog
+// timeout (250 ms). On AVR the watchdog first fires its interrupt, which saves a
+// StallRecord to EEPROM, and resets on the next timeout. The record is only
+// believed after a watchdog reset, a pass that ran long and then recovered
+// leaves one behind too. Passes longer than the soft deadline are counted as
+// overruns on every platform, the sketch shows them on the dashboard.
+class LoopWatchdog {
+  private:
+    unsigned long deadline;
+    unsigned long loopStart = 0;
+    volatile uint8_t stage = STAGE_NONE;
+
+    StallRecord lastStall = { 0, STAGE_NONE, 0, 0 };
+
+  public:
+    uint16_t overrunCount = 0;
+    uint8_t lastOverrunStage = STAGE_NONE;
+    unsigned long longestLoop = 0;
+
+    LoopWatchdog(unsigned long deadlineMillis) :
+      deadline(deadlineMillis) {
+    }
+
+    // Call first in setup(), reads back the record of a previous stall and
+    // starts the watchdog. Returns true if the last reset was caused by a stall.
+    bool setup() {
+      bool stalled = false;
+#ifdef __AVR__
+      bool watchdogReset = MCUSR & (1 << WDRF);
+      MCUSR &= ~(1 << WDRF);
+      eeprom_read_block(&lastStall, (const void *)STALL_RECORD_ADDRESS, sizeof(lastStall));
+      if (lastStall.magic == STALL_RECORD_MAGIC) {
+        stalled = watchdogReset;
+        eeprom_update_byte((uint8_t *)STALL_RECORD_ADDRESS, 0);
+      }
+
+      // Interrupt and reset mode, the interrupt gets one timeout to save the record
+      cli();
+      wdt_reset();
+      WDTCSR = (1 << WDCE) | (1 << WDE);
+      WDTCSR = (1 << WDIE) | (1 << WDE) | (1 << WDP2); // 250 ms
+      sei();
+#endif
+      return stalled;
+    }
+
+    // Call last in setup(), the first loop pass is timed from here instead of
+    // including the ESC, display and LED initialisation
+    void endSetup() {
+      loopStart = millis();
+#ifdef __AVR__
+      wdt_reset();
+#endif
+    }
+
+    const StallRecord &getLastStall() {
+      return lastStall;
+    }
+
+    // Call at the start of every loop pass
+    void beginLoop() {
+      unsigned long now = millis();
+      unsigned long duration = now - loopStart;
+      if (duration > longestLoop) {
+        longestLoop = duration;
+      }
+      if (duration > deadline) {
+        overrunCount++;
+        lastOverrunStage = stage;
+      }
+      loopStart = now;
+      stage = STAGE_NONE;
+#ifdef __AVR__
+      wdt_reset();
+      // The interrupt clears WDIE when it fires, without it the next timeout
+      // would reset the board with no record
+      WDTCSR |= (1 << WDIE);
+#endif
+    }
+
+    void setStage(LoopStage loopStage) {
+      stage = loopStage;
+    }
+
+    // Called from the watchdog interrupt
+    void saveStallRecord(uint32_t lastCanId) {
+      StallRecord record = { STALL_RECORD_MAGIC, stage, lastCanId, (uint32_t)millis() };
+      lastStall = record;
+#ifdef __AVR__
+      eeprom_update_block(&record, (void *)STALL_RECORD_ADDRESS, sizeof(record));
+#endif
+    }
+};
+
+#endif
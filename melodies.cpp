@@ -0,0 +1,40 @@
+// Generated by tools/melody_compiler.py from melodies.rtttl, edit that file instead
+// 4 melodies, 38 bytes of flash (0 saved by shared endings)
+
+#ifndef MELODIES_CPP
+#define MELODIES_CPP
+
+#include "beeper.cpp"
+
+const uint16_t MELODY_TABLE[] PROGMEM = {
+  // three_short
+  MELODY_NOTE(69, 250),
+  MELODY_REST(90),
+  MELODY_NOTE(81, 250),
+  MELODY_REST(90),
+  MELODY_NOTE(93, 250),
+  MELODY_REST(90),
+  MELODY_END,
+  // sad
+  MELODY_NOTE(102, 100),
+  MELODY_NOTE(99, 100),
+  MELODY_NOTE(95, 100),
+  MELODY_NOTE(90, 100),
+  MELODY_NOTE(83, 100),
+  MELODY_NOTE(71, 100),
+  MELODY_END,
+  // long_single
+  MELODY_NOTE(69, 750),
+  MELODY_REST(250),
+  MELODY_END,
+  // short_single
+  MELODY_NOTE(69, 300),
+  MELODY_END,
+};
+
+const uint16_t *const MELODY_LONG_SINGLE = MELODY_TABLE + 14;
+const uint16_t *const MELODY_SAD = MELODY_TABLE + 7;
+const uint16_t *const MELODY_SHORT_SINGLE = MELODY_TABLE + 17;
+const uint16_t *const MELODY_THREE_SHORT = MELODY_TABLE + 0;
+
+#endif
@@ -0,0 +1,204 @@
+#ifndef RIDE_STATE_CPP
+#define RIDE_STATE_CPP
+
+#include <Arduino.h>
+#include "telemetry.cpp"
+
+#define MOVING_ERPM_THRESHOLD 200 // above this the board starts counting as moving
+#define STOPPED_ERPM_THRESHOLD 150 // below this a moving board counts as stopped
+
+// All states of the light module
+enum RideState : uint8_t {
+  RIDE_BOOT = 0,
+  RIDE_STARTUP_ANIMATION,
+  RIDE_IDLE,
+  RIDE_BATTERY_GAUGE,
+  RIDE_FOOTPAD_HINT,
+  RIDE_MOVING_FORWARD,
+  RIDE_MOVING_REVERSE,
+  RIDE_BRAKING,
+  RIDE_STATE_COUNT
+};
+
+// Events derived from the telemetry, in the order they are checked
+enum RideEvent : uint8_t {
+  RIDE_EVENT_BOOTED = 0,
+  RIDE_EVENT_TIMER_EXPIRED,
+  RIDE_EVENT_BRAKE_ON,
+  RIDE_EVENT_MOVE_FORWARD,
+  RIDE_EVENT_MOVE_REVERSE,
+  RIDE_EVENT_STOPPED,
+  RIDE_EVENT_BOTH_FOOTPADS,
+  RIDE_EVENT_ONE_FOOTPAD,
+  RIDE_EVENT_NO_FOOTPAD,
+  RIDE_EVENT_VOLTAGE_ACQUIRED
+};
+
+struct RideTransition {
+  uint8_t from;
+  uint8_t event;
+  uint8_t to;
+};
+
+// Transition table (from, event, to). A transition to the same state is
+// internal: no exit/entry actions, it only restarts the state timer.
+static const RideTransition RIDE_TRANSITIONS[] PROGMEM = {
+  { RIDE_BOOT,              RIDE_EVENT_BOOTED,           RIDE_STARTUP_ANIMATION },
+
+  { RIDE_STARTUP_ANIMATION, RIDE_EVENT_TIMER_EXPIRED,    RIDE_IDLE },
+  { RIDE_STARTUP_ANIMATION, RIDE_EVENT_MOVE_FORWARD,     RIDE_MOVING_FORWARD },
+  { RIDE_STARTUP_ANIMATION, RIDE_EVENT_MOVE_REVERSE,     RIDE_MOVING_REVERSE },
+
+  { RIDE_IDLE,              RIDE_EVENT_MOVE_FORWARD,     RIDE_MOVING_FORWARD },
+  { RIDE_IDLE,              RIDE_EVENT_MOVE_REVERSE,     RIDE_MOVING_REVERSE },
+  { RIDE_IDLE,              RIDE_EVENT_BOTH_FOOTPADS,    RIDE_BATTERY_GAUGE },
+  { RIDE_IDLE,              RIDE_EVENT_ONE_FOOTPAD,      RIDE_FOOTPAD_HINT },
+  { RIDE_IDLE,              RIDE_EVENT_VOLTAGE_ACQUIRED, RIDE_BATTERY_GAUGE },
+
+  { RIDE_BATTERY_GAUGE,     RIDE_EVENT_TIMER_EXPIRED,    RIDE_IDLE },
+  { RIDE_BATTERY_GAUGE,     RIDE_EVENT_MOVE_FORWARD,     RIDE_MOVING_FORWARD },
+  { RIDE_BATTERY_GAUGE,     RIDE_EVENT_MOVE_REVERSE,     RIDE_MOVING_REVERSE },
+  { RIDE_BATTERY_GAUGE,     RIDE_EVENT_BOTH_FOOTPADS,    RIDE_BATTERY_GAUGE },
+
+  { RIDE_FOOTPAD_HINT,      RIDE_EVENT_MOVE_FORWARD,     RIDE_MOVING_FORWARD },
+  { RIDE_FOOTPAD_HINT,      RIDE_EVENT_MOVE_REVERSE,     RIDE_MOVING_REVERSE },
+  { RIDE_FOOTPAD_HINT,      RIDE_EVENT_BOTH_FOOTPADS,    RIDE_BATTERY_GAUGE },
+  { RIDE_FOOTPAD_HINT,      RIDE_EVENT_NO_FOOTPAD,       RIDE_IDLE },
+
+  { RIDE_MOVING_FORWARD,    RIDE_EVENT_BRAKE_ON,         RIDE_BRAKING },
+  { RIDE_MOVING_FORWARD,    RIDE_EVENT_MOVE_REVERSE,     RIDE_MOVING_REVERSE },
+  { RIDE_MOVING_FORWARD,    RIDE_EVENT_STOPPED,          RIDE_IDLE },
+
+  { RIDE_MOVING_REVERSE,    RIDE_EVENT_BRAKE_ON,         RIDE_BRAKING },
+  { RIDE_MOVING_REVERSE,    RIDE_EVENT_MOVE_FORWARD,     RIDE_MOVING_FORWARD },
+  { RIDE_MOVING_REVERSE,    RIDE_EVENT_STOPPED,          RIDE_IDLE },
+
+  // Move events come with the brake still on, it holds the state first
+  { RIDE_BRAKING,           RIDE_EVENT_BRAKE_ON,         RIDE_BRAKING },
+  { RIDE_BRAKING,           RIDE_EVENT_MOVE_FORWARD,     RIDE_MOVING_FORWARD },
+  { RIDE_BRAKING,           RIDE_EVENT_MOVE_REVERSE,     RIDE_MOVING_REVERSE },
+  { RIDE_BRAKING,           RIDE_EVENT_STOPPED,          RIDE_IDLE },
+};
+
+typedef void (*RideStateAction)(RideState state);
+
+class RideStateMachine {
+  private:
+    static const uint8_t MAX_TRANSITIONS_PER_UPDATE = 4;
+
+    RideState state = RIDE_BOOT;
+    RideStateAction onEnter;
+    RideStateAction onExit;
+
+    unsigned long timerStart = 0;
+    unsigned long timerDuration = 0;
+    bool timerArmed = false;
+
+    // The battery gauge is shown once on its own when the first voltage arrives
+    bool initialGaugePending = true;
+
+  public:
+    RideStateMachine(RideStateAction enterAction, RideStateAction exitAction) :
+      onEnter(enterAction), onExit(exitAction) {
+    }
+
+    RideState getState() {
+      return state;
+    }
+
+    // Called from the entry actions of states that time out
+    void startTimer(unsigned long duration) {
+      timerStart = millis();
+      timerDuration = duration;
+      timerArmed = true;
+    }
+
+    bool timerExpired() {
+      return timerArmed && millis() - timerStart >= timerDuration;
+    }
+
+    // Run only when new telemetry arrived or the timer expired.
+    // Keeps firing transitions until the state is stable.
+    void update(const Telemetry &telemetry) {
+      for (uint8_t i = 0; i < MAX_TRANSITIONS_PER_UPDATE; i++) {
+        if (!step(telemetry)) {
+          return;
+        }
+      }
+    }
+
+  private:
+    bool step(const Telemetry &telemetry) {
+      RideEvent events[6];
+      uint8_t eventCount = 0;
+
+      if (state == RIDE_BOOT) {
+        events[eventCount++] = RIDE_EVENT_BOOTED;
+      }
+      if (timerExpired()) {
+        events[eventCount++] = RIDE_EVENT_TIMER_EXPIRED;
+      }
+
+      // Hysteresis, so hovering around the threshold doesn't toggle the state
+      bool moving = state == RIDE_MOVING_FORWARD || state == RIDE_MOVING_REVERSE || state == RIDE_BRAKING;
+      int32_t threshold = moving ? STOPPED_ERPM_THRESHOLD : MOVING_ERPM_THRESHOLD;
+      // Moving follows from the ERPM alone, a latched brake detector doesn't
+      // keep a board that starts rolling in IDLE. Braking is only a way out
+      // of the moving states, which check it first.
+      if (telemetry.erpm > threshold || telemetry.erpm < -threshold) {
+        if (telemetry.braking) {
+          events[eventCount++] = RIDE_EVENT_BRAKE_ON;
+        }
+        events[eventCount++] = telemetry.erpm > 0 ? RIDE_EVENT_MOVE_FORWARD : RIDE_EVENT_MOVE_REVERSE;
+      } else {
+        events[eventCount++] = RIDE_EVENT_STOPPED;
+      }
+
+      if (telemetry.footpad1 && telemetry.footpad2) {
+        events[eventCount++] = RIDE_EVENT_BOTH_FOOTPADS;
+      } else if (telemetry.footpad1 || telemetry.footpad2) {
+        events[eventCount++] = RIDE_EVENT_ONE_FOOTPAD;
+      } else {
+        events[eventCount++] = RIDE_EVENT_NO_FOOTPAD;
+      }
+
+      if (initialGaugePending && telemetry.voltage != 0.0) {
+        events[eventCount++] = RIDE_EVENT_VOLTAGE_ACQUIRED;
+      }
+
+      for (uint8_t e = 0; e < eventCount; e++) {
+        RideState next = lookup(state, events[e]);
+        if (next == state) {
+          timerStart = millis();
+          return false;
+        }
+        if (next != RIDE_STATE_COUNT) {
+          transition(next);
+          return true;
+        }
+      }
+      return false;
+    }
+
+    RideState lookup(RideState from, RideEvent event) {
+      for (uint8_t i = 0; i < sizeof(RIDE_TRANSITIONS) / sizeof(RIDE_TRANSITIONS[0]); i++) {
+        if (pgm_read_byte(&RIDE_TRANSITIONS[i].from) == from &&
+            pgm_read_byte(&RIDE_TRANSITIONS[i].event) == event) {
+          return (RideState)pgm_read_byte(&RIDE_TRANSITIONS[i].to);
+        }
+      }
+      return RIDE_STATE_COUNT;
+    }
+
+    void transition(RideState next) {
+      onExit(state);
+      timerArmed = false;
+      if (next == RIDE_BATTERY_GAUGE) {
+        initialGaugePending = false;
+      }
+      state = next;
+      onEnter(state);
+    }
+};
+
+#endif
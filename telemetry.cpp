@@ -0,0 +1,24 @@
+#ifndef TELEMETRY_CPP
+#define TELEMETRY_CPP
+
+#include <stdint.h>
+
+// Snapshot of the ESC data the light logic works on.
+// Filled in by the main loop whenever new CAN data was parsed.
+struct Telemetry {
+  int32_t erpm = 0;
+  double voltage = 0.0;
+  double dutyCycle = 0.0;
+
+  // Filtered state of charge, 0 is empty and 255 is full
+  uint8_t batteryLevel = 0;
+
+  // Footpad sensors (adc1 / adc2 above the footpad threshold)
+  bool footpad1 = false;
+  bool footpad2 = false;
+
+  // Result of the brake detection
+  bool braking = false;
+};
+
+#endif
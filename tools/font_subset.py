@@ -0,0 +1,301 @@
+#!/usr/bin/env python3
+"""Cut an SSD1306Ascii font down to the characters a sketch uses.
+
+Usage: python3 tools/font_subset.py [--rle] [--name NAME] font.h chars output.h
+
+font.h is one of the font headers of libs/SSD1306Ascii/src/fonts, chars the
+characters to keep, e.g. "0123456789.-". The output is a font header with
+the same glyphs for those characters that the sketch includes after
+SSD1306Ascii.h, by default the font is named <font>_<characters kept>.
+
+Character codes don't change, the font covers the range from the lowest to
+the highest character kept. Characters in between that weren't asked for get
+a width of 0, which costs one byte of the width table and no glyph data. A
+fixed width font whose characters aren't one range is stored as a
+proportional font for that, its height is rounded up to whole rows so the
+glyphs don't move.
+
+With --rle the glyphs are run length encoded, type 00 02 in allFonts.h. These
+fonts only hold the characters kept, a sorted table of their codes maps a
+character to its glyph, and the glyph is found through a table of offsets
+instead of the widths, so drawing one doesn't depend on the size of the
+font. The tables cost 4 bytes per character, for small glyphs that can be
+more than the encoding saves, then a warning is printed and the font is
+written without --rle.
+
+The flash cost before and after is printed and written into the output.
+"""
+
+import re
+import sys
+
+# Values of the first two bytes
+FIXED_PADDED = 0
+FIXED_UNPADDED = 1
+RLE = 2
+
+MAX_LITERAL = 128
+MAX_REPEAT = 129
+
+
+class FontError(Exception):
+    pass
+
+
+def read_font(path):
+    """Returns (name, bytes) of the GLCDFONTDECL in a font header"""
+    with open(path) as f:
+        source = f.read()
+    source = re.sub(r'/\*.*?\*/', ' ', source, flags=re.S)
+    source = re.sub(r'//[^\n]*', ' ', source)
+    match = re.search(r'GLCDFONTDECL\s*\(\s*(\w+)\s*\)\s*=\s*\{(.*?)\}', source, re.S)
+    if not match:
+        raise FontError('no GLCDFONTDECL in %s' % path)
+    data = []
+    for token in filter(None, (t.strip() for t in match.group(2).split(','))):
+        if re.match(r"^'(\\?.)'$", token):
+            data.append(ord(token[1:-1].encode().decode('unicode_escape')))
+        else:
+            try:
+                data.append(int(token, 0))
+            except ValueError:
+                raise FontError('bad value %r in %s' % (token, path))
+    if len(data) < 6:
+        raise FontError('%s is too short for a font' % path)
+    return match.group(1), data
+
+
+def parse_font(data):
+    """Returns (type, width, height, {char: (width, column bytes)})"""
+    kind = data[0] << 8 | data[1]
+    width, height, first, count = data[2:6]
+    rows = (height + 7) // 8
+    glyphs = {}
+    if kind in (FIXED_PADDED, FIXED_UNPADDED):
+        size = width * rows
+        for i in range(count):
+            start = 6 + i * size
+            glyphs[first + i] = (width, data[start:start + size])
+    elif kind == RLE:
+        raise FontError('font is already run length encoded')
+    else:
+        widths = data[6:6 + count]
+        start = 6 + count
+        for i, w in enumerate(widths):
+            glyphs[first + i] = (w, data[start:start + w * rows])
+            start += w * rows
+    for char, (w, columns) in glyphs.items():
+        if len(columns) != w * rows:
+            raise FontError('font data ends in character %r' % chr(char))
+    return kind, width, height, glyphs
+
+
+def rle_encode(columns):
+    """Runs of 3 or more bytes as 0x80 | (count - 2), byte. Other bytes as
+    count - 1 followed by up to 128 bytes."""
+    out = []
+    literal = []
+    i = 0
+    while i < len(columns):
+        run = 1
+        while i + run < len(columns) and columns[i + run] == columns[i] and run < MAX_REPEAT:
+            run += 1
+        if run >= 3:
+            if literal:
+                out += [len(literal) - 1] + literal
+                literal = []
+            out += [0x80 | (run - 2), columns[i]]
+            i += run
+        else:
+            literal.append(columns[i])
+            if len(literal) == MAX_LITERAL:
+                out += [len(literal) - 1] + literal
+                literal = []
+            i += 1
+    if literal:
+        out += [len(literal) - 1] + literal
+    return out
+
+
+def rle_decode(encoded, length):
+    out = []
+    i = 0
+    while len(out) < length:
+        control = encoded[i]
+        if control & 0x80:
+            out += [encoded[i + 1]] * ((control & 0x7F) + 2)
+            i += 2
+        else:
+            out += encoded[i + 1:i + 2 + control]
+            i += control + 2
+    return out
+
+
+def subset(kind, width, height, glyphs, chars, rle):
+    """Returns the bytes of the subsetted font"""
+    if rle:
+        return subset_rle(kind, height, glyphs, chars)
+    first, last = min(chars), max(chars)
+    count = last - first + 1
+    rows = (height + 7) // 8
+    used = [glyphs[c] if c in chars else (0, []) for c in range(first, last + 1)]
+    max_width = max(w for w, _ in used)
+
+    if kind in (FIXED_PADDED, FIXED_UNPADDED) and count == len(chars):
+        data = [0, kind, width, height, first, count]
+        for _, columns in used:
+            data += columns
+        return data
+
+    # Fixed width fonts keep their bits where they are, proportional ones
+    # are shifted for the last row when the height isn't whole rows
+    if kind in (FIXED_PADDED, FIXED_UNPADDED):
+        height = rows * 8
+    widths = [w for w, _ in used]
+    data = [0, 0, max_width, height, first, count] + widths
+    for _, columns in used:
+        data += columns
+    data[0:2] = [len(data) >> 8, len(data) & 0xFF]
+    return data
+
+
+def subset_rle(kind, height, glyphs, chars):
+    """Returns the bytes of the run length encoded font, only the characters
+    kept with a table of their codes"""
+    codes = sorted(chars)
+    used = [glyphs[c] for c in codes]
+    if kind in (FIXED_PADDED, FIXED_UNPADDED):
+        height = (height + 7) // 8 * 8
+    streams = [rle_encode(columns) for _, columns in used]
+    offsets = []
+    offset = 0
+    for stream in streams:
+        offsets += [offset >> 8, offset & 0xFF]
+        offset += len(stream)
+    if offset > 0xFFFF:
+        raise FontError('font is too large for 16 bit offsets')
+    widths = [w for w, _ in used]
+    data = [0, RLE, max(widths), height, codes[0], len(codes)] + codes + widths + offsets
+    for stream, (_, columns) in zip(streams, used):
+        assert rle_decode(stream, len(columns)) == columns
+        data += stream
+    return data
+
+
+def describe(char):
+    return "'%s'" % ('\\\'' if char == "'" else '\\\\' if char == '\\' else char)
+
+
+def generate(name, source_name, source_size, chars, data, rle):
+    kind = data[0] << 8 | data[1]
+    count = data[5]
+    first = data[4]
+    lines = [
+        '// Generated by tools/font_subset.py from %s, %d of %d bytes, regenerate instead of editing'
+        % (source_name, len(data), source_size),
+        '// Characters: %s' % ''.join(chr(c) for c in sorted(chars)),
+        '',
+        '#ifndef _%s_H' % name,
+        '#define _%s_H' % name,
+        '',
+        'GLCDFONTDECL(%s) = {' % name,
+    ]
+    if kind == RLE:
+        lines.append('  0x00, 0x02, // run length encoded')
+    elif kind in (FIXED_PADDED, FIXED_UNPADDED):
+        lines.append('  0x00, 0x%02X, // fixed width' % kind)
+    else:
+        lines.append('  0x%02X, 0x%02X, // size' % (data[0], data[1]))
+    lines += [
+        '  %d, // width' % data[2],
+        '  %d, // height' % data[3],
+        '  %s, // first char' % describe(chr(first)),
+        '  %d, // char count' % count,
+    ]
+    rows = (data[3] + 7) // 8
+    position = 6
+    codes = list(range(first, first + count))
+    if kind == RLE:
+        codes = data[6:6 + count]
+        lines.append('  // chars')
+        lines.append('  ' + ' '.join('%s,' % describe(chr(c)) for c in codes))
+        position += count
+    if kind not in (FIXED_PADDED, FIXED_UNPADDED):
+        widths = data[position:position + count]
+        lines.append('  // char widths')
+        lines.append('  ' + ' '.join('%d,' % w for w in widths))
+        position += count
+        if kind == RLE:
+            lines.append('  // offsets')
+            offsets = data[position:position + 2 * count]
+            lines.append('  ' + ' '.join('0x%02X,' % b for b in offsets))
+            position += 2 * count
+            ends = [(offsets[2 * i] << 8 | offsets[2 * i + 1]) for i in range(1, count)] + [len(data) - position]
+            starts = [0] + ends[:-1]
+            sizes = [e - s for s, e in zip(starts, ends)]
+        else:
+            sizes = [w * rows for w in widths]
+    else:
+        sizes = [data[2] * rows] * count
+    for i, size in enumerate(sizes):
+        if size == 0:
+            continue
+        glyph = data[position:position + size]
+        position += size
+        lines.append('  // %s' % describe(chr(codes[i])))
+        for start in range(0, size, 16):
+            lines.append('  ' + ' '.join('0x%02X,' % b for b in glyph[start:start + 16]))
+    lines += ['};', '', '#endif', '']
+    return '\n'.join(lines)
+
+
+def main(argv):
+    args = argv[1:]
+    rle = '--rle' in args
+    if rle:
+        args.remove('--rle')
+    name = None
+    if '--name' in args:
+        i = args.index('--name')
+        name = args[i + 1] if i + 1 < len(args) else None
+        del args[i:i + 2]
+    if len(args) != 3 or (name is not None and not re.match(r'^[A-Za-z_]\w*$', name)):
+        sys.stderr.write(__doc__)
+        return 2
+    source, wanted, target = args
+
+    try:
+        font_name, data = read_font(source)
+        kind, width, height, glyphs = parse_font(data)
+        chars = set(ord(c) for c in wanted)
+        missing = sorted(c for c in chars if c not in glyphs)
+        if missing:
+            raise FontError('%s has no %s' % (font_name, ', '.join(describe(chr(c)) for c in missing)))
+        result = subset(kind, width, height, glyphs, chars, rle)
+        plain = subset(kind, width, height, glyphs, chars, False)
+    except FontError as e:
+        sys.stderr.write('%s: %s\n' % (source, e))
+        return 1
+
+    if rle and len(result) >= len(plain):
+        sys.stderr.write('warning: %d bytes run length encoded, %d without, writing it without --rle\n'
+                         % (len(result), len(plain)))
+        result = plain
+        rle = False
+
+    if name is None:
+        name = font_name + '_' + ''.join(c if re.match(r'\w', c) else '' for c in sorted(wanted))
+    with open(target, 'w') as f:
+        f.write(generate(name, source.replace('\\', '/').split('/')[-1], len(data), chars, result, rle))
+
+    print('%s: %d bytes, %d characters' % (font_name, len(data), len(glyphs)))
+    print('%s: %d bytes, %d characters' % (name, len(result), len(chars)))
+    if rle:
+        print('run length encoded, %d bytes without --rle' % len(plain))
+    if kind == FIXED_UNPADDED and result[0:2] != [0, FIXED_UNPADDED]:
+        print('note: the font has no padding pixel, call setLetterSpacing(0) after setFont()')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -0,0 +1,177 @@
+#!/usr/bin/env python3
+"""Compile RTTTL melodies into the packed PROGMEM note tables of beeper.cpp.
+
+Usage: python3 tools/melody_compiler.py melodies.rtttl melodies.cpp
+
+Every non-empty line of the input that doesn't start with '#' is an RTTTL
+string, name:d=4,o=5,b=120:notes. The melody is available to the sketch as
+MELODY_<NAME>, with the name in upper case.
+
+All melodies are stored in one table. A melody that ends with the same notes
+as another one starts inside that one's notes instead of being stored again.
+The flash cost is printed and written into the generated file.
+"""
+
+import re
+import sys
+
+# Longest note a word can hold, 9 bits of 10 ms
+MAX_STEPS = 511
+
+NOTE_OFFSETS = {'c': 0, 'd': 2, 'e': 4, 'f': 5, 'g': 7, 'a': 9, 'b': 11, 'h': 11}
+
+NOTE_RE = re.compile(r'^(\d*)([a-hp])(#?)(\.?)(\d?)(\.?)$')
+
+
+class MelodyError(Exception):
+    pass
+
+
+def parse_rtttl(line):
+    """Returns (name, [(midi note or 0 for a rest, ms), ...])"""
+    parts = line.split(':')
+    if len(parts) != 3:
+        raise MelodyError('expected name:defaults:notes')
+    name, defaults, notes = (p.strip() for p in parts)
+    if not re.match(r'^[A-Za-z_][A-Za-z0-9_]*$', name):
+        raise MelodyError('melody name %r is not a valid identifier' % name)
+
+    settings = {'d': 4, 'o': 6, 'b': 63}
+    for setting in filter(None, (s.strip() for s in defaults.split(','))):
+        key, _, value = setting.partition('=')
+        key = key.strip().lower()
+        if key not in settings or not value.strip().isdigit():
+            raise MelodyError('bad default %r' % setting)
+        settings[key] = int(value)
+    if settings['b'] == 0 or settings['d'] == 0:
+        raise MelodyError('duration and tempo must not be 0')
+
+    whole_ms = 4 * 60000.0 / settings['b']
+    result = []
+    for token in filter(None, (t.strip().lower() for t in notes.split(','))):
+        match = NOTE_RE.match(token)
+        if not match:
+            raise MelodyError('bad note %r' % token)
+        duration, letter, sharp, dot1, octave, dot2 = match.groups()
+        ms = whole_ms / int(duration or settings['d'])
+        if dot1 or dot2:
+            ms *= 1.5
+        if letter == 'p':
+            note = 0
+        else:
+            octave = int(octave or settings['o'])
+            # a4 is MIDI note 69, 440 Hz
+            note = 12 * (octave + 1) + NOTE_OFFSETS[letter] + (1 if sharp else 0)
+            if not 1 <= note <= 127:
+                raise MelodyError('note %r out of range' % token)
+        result.append((note, ms))
+    if not result:
+        raise MelodyError('melody has no notes')
+    return name, result
+
+
+def pack(notes):
+    """Returns the (note, steps of 10 ms) words of a melody, without the end marker"""
+    words = []
+    for note, ms in notes:
+        steps = max(1, int(round(ms / 10.0)))
+        # Longer notes are split, the note just starts again where the word ends
+        while steps > 0:
+            chunk = min(steps, MAX_STEPS)
+            words.append((note, chunk))
+            steps -= chunk
+    return words
+
+
+def layout(melodies):
+    """Lays the melodies out in one table, sharing identical endings.
+
+    Returns the table and the start of every melody in it."""
+    table = []
+    ends = []  # (start, length) of every melody stored in full, END included
+    starts = {}
+    # Longest first, so shorter melodies can start inside them
+    for name, words in sorted(melodies.items(), key=lambda m: -len(m[1])):
+        sequence = words + [None]
+        for start, length in ends:
+            offset = start + length - len(sequence)
+            if offset >= start and table[offset:start + length] == sequence:
+                starts[name] = offset
+                break
+        else:
+            starts[name] = len(table)
+            ends.append((len(table), len(sequence)))
+            table.extend(sequence)
+    return table, starts
+
+
+def generate(source_name, melodies, table, starts):
+    unshared = sum(len(words) + 1 for words in melodies.values())
+    lines = [
+        '// Generated by tools/melody_compiler.py from %s, edit that file instead' % source_name,
+        '// %d melodies, %d bytes of flash (%d saved by shared endings)'
+        % (len(melodies), 2 * len(table), 2 * (unshared - len(table))),
+        '',
+        '#ifndef MELODIES_CPP',
+        '#define MELODIES_CPP',
+        '',
+        '#include "beeper.cpp"',
+        '',
+        'const uint16_t MELODY_TABLE[] PROGMEM = {',
+    ]
+    first = {}
+    for name, start in starts.items():
+        first.setdefault(start, []).append(name)
+    for index, word in enumerate(table):
+        for name in sorted(first.get(index, [])):
+            lines.append('  // %s' % name)
+        if word is None:
+            lines.append('  MELODY_END,')
+        elif word[0] == 0:
+            lines.append('  MELODY_REST(%d),' % (word[1] * 10))
+        else:
+            lines.append('  MELODY_NOTE(%d, %d),' % (word[0], word[1] * 10))
+    lines.append('};')
+    lines.append('')
+    for name in sorted(starts):
+        lines.append('const uint16_t *const MELODY_%s = MELODY_TABLE + %d;' % (name.upper(), starts[name]))
+    lines.append('')
+    lines.append('#endif')
+    return '\n'.join(lines) + '\n'
+
+
+def main(argv):
+    if len(argv) != 3:
+        sys.stderr.write(__doc__)
+        return 2
+    source, target = argv[1], argv[2]
+
+    melodies = {}
+    with open(source) as f:
+        for number, line in enumerate(f, 1):
+            line = line.strip()
+            if not line or line.startswith('#'):
+                continue
+            try:
+                name, notes = parse_rtttl(line)
+            except MelodyError as e:
+                sys.stderr.write('%s:%d: %s\n' % (source, number, e))
+                return 1
+            if name.upper() in (n.upper() for n in melodies):
+                sys.stderr.write('%s:%d: melody %s defined twice\n' % (source, number, name))
+                return 1
+            melodies[name] = pack(notes)
+
+    table, starts = layout(melodies)
+    with open(target, 'w') as f:
+        f.write(generate(source.replace('\\', '/').split('/')[-1], melodies, table, starts))
+
+    for name in sorted(melodies):
+        print('%-20s %4d bytes' % (name, 2 * (len(melodies[name]) + 1)))
+    unshared = sum(len(words) + 1 for words in melodies.values())
+    print('%-20s %4d bytes, %d saved by shared endings' % ('total', 2 * len(table), 2 * (unshared - len(table))))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))